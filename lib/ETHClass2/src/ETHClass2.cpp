@@ -1008,6 +1008,14 @@ uint8_t *ETHClass2::macAddress(uint8_t *mac)
     return mac;
 }
 
+bool ETHClass2::transmit(const uint8_t *frame, size_t length)
+{
+    if (_eth_handle == NULL || !_eth_started) {
+        return false;
+    }
+    return esp_eth_transmit(_eth_handle, (void *)frame, length) == ESP_OK;
+}
+
 String ETHClass2::macAddress(void)
 {
     uint8_t mac[6] = {0, 0, 0, 0, 0, 0};
@@ -163,6 +163,8 @@ class ETHClass2 {
         uint8_t linkSpeed();
         bool autoNegotiation();
         uint32_t phyAddr();
+        // Sends a raw Ethernet frame (without FCS), bypassing the IP stack
+        bool transmit(const uint8_t * frame, size_t length);
 
         // Info APIs
         void printInfo(Print & out);
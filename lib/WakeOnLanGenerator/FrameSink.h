@@ -0,0 +1,31 @@
+/*
+ * FrameSink.h
+ *
+ * Created on: 17.10.2026
+ *
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at https://opensource.org/licenses/MIT.
+ */
+
+#ifndef LIB_FRAMESINK_H_
+#define LIB_FRAMESINK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Destination for raw Ethernet frames.
+ */
+class FrameSink {
+public:
+	virtual ~FrameSink() {
+	}
+
+	/*
+	 * Sends a complete Ethernet frame, without the frame check sequence.
+	 * Returns false if the frame couldn't be sent.
+	 */
+	virtual bool sendFrame(const uint8_t *frame, size_t length) = 0;
+};
+
+#endif /* LIB_FRAMESINK_H_ */
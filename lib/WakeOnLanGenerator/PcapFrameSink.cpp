@@ -0,0 +1,72 @@
+/*
+ * PcapFrameSink.cpp
+ *
+ * Created on: 17.10.2026
+ *
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at https://opensource.org/licenses/MIT.
+ */
+
+#include "PcapFrameSink.h"
+#include <time.h>
+
+namespace {
+
+/*
+ * pcap headers, written in host byte order as the format allows.
+ */
+struct PcapFileHeader {
+	uint32_t magic;
+	uint16_t versionMajor;
+	uint16_t versionMinor;
+	int32_t thisZone;
+	uint32_t sigFigs;
+	uint32_t snapLength;
+	uint32_t linkType;
+};
+
+struct PcapRecordHeader {
+	uint32_t seconds;
+	uint32_t microseconds;
+	uint32_t capturedLength;
+	uint32_t originalLength;
+};
+
+const uint32_t kPcapMagic = 0xA1B2C3D4;
+const uint32_t kLinkTypeEthernet = 1;
+
+}
+
+bool PcapFrameSink::open(const char *path) {
+	close();
+	file = fopen(path, "wb");
+	if (file == NULL) {
+		return false;
+	}
+
+	const PcapFileHeader header = { kPcapMagic, 2, 4, 0, 0, 65535,
+			kLinkTypeEthernet };
+	if (fwrite(&header, sizeof(header), 1, file) != 1) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void PcapFrameSink::close() {
+	if (file != NULL) {
+		fclose(file);
+		file = NULL;
+	}
+}
+
+bool PcapFrameSink::sendFrame(const uint8_t *frame, size_t length) {
+	if (file == NULL) {
+		return false;
+	}
+
+	const PcapRecordHeader record = { (uint32_t) time(NULL), 0,
+			(uint32_t) length, (uint32_t) length };
+	return fwrite(&record, sizeof(record), 1, file) == 1
+			&& fwrite(frame, 1, length, file) == length;
+}
@@ -0,0 +1,43 @@
+/*
+ * PcapFrameSink.h
+ *
+ * Created on: 17.10.2026
+ *
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at https://opensource.org/licenses/MIT.
+ */
+
+#ifndef LIB_PCAPFRAMESINK_H_
+#define LIB_PCAPFRAMESINK_H_
+
+#include <stdio.h>
+#include "FrameSink.h"
+
+/*
+ * Frame sink writing every frame to a pcap file, so frames built on a host
+ * can be checked with Wireshark or tcpdump.
+ */
+class PcapFrameSink: public FrameSink {
+public:
+	PcapFrameSink() :
+			file(NULL) {
+	}
+
+	~PcapFrameSink() {
+		close();
+	}
+
+	/*
+	 * Creates the given file and writes the pcap file header.
+	 */
+	bool open(const char *path);
+
+	void close();
+
+	bool sendFrame(const uint8_t *frame, size_t length) override;
+
+private:
+	FILE *file;
+};
+
+#endif /* LIB_PCAPFRAMESINK_H_ */
@@ -9,39 +9,121 @@
  */
 
 #include "WakeOnLanGenerator.h"
-#include <sstream>
+#include <string.h>
 
+namespace {
+
+/*
+ * Maps every byte to its hex digit value, or 0xFF if it isn't a hex digit.
+ */
+const uint8_t kHexDigits[256] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+}
+
+#if defined(ESP32) || defined(ESP8266)
 AsyncUDPMessage WakeOnLanGenerator::generateWoLPacket(const char *targetMac) {
 	AsyncUDPMessage message;
-	for (uint8_t i = 0; i < 6; i++) {
-		message.write(0xFF);
+	MacAddress target;
+	if (!parseMacAddr(targetMac, target)) {
+		return message;
 	}
 
-	const uint8_t *target = parseMacAddr(targetMac);
-	for (uint8_t i = 0; i < 16; i++) {
-		message.write(target, 6);
-	}
-	delete[] target;
+	uint8_t packet[kMagicPacketSize];
+	buildMagicPacket(target, packet);
+	message.write(packet, kMagicPacketSize);
 
 	return message;
 }
+#endif
+
+void WakeOnLanGenerator::buildMagicPacket(const MacAddress &target, uint8_t *packet) {
+	memset(packet, 0xFF, 6);
+	for (uint8_t i = 1; i <= 16; i++) {
+		memcpy(packet + i * 6, target.data(), 6);
+	}
+}
 
-const uint8_t* WakeOnLanGenerator::parseMacAddr(const char *mac) {
-	if (!isValidMac(mac)) {
-		return NULL;
+bool WakeOnLanGenerator::parseMacAddr(const char *mac, MacAddress &parsed) {
+	if (mac == NULL) {
+		return false;
 	}
 
-	uint8_t *parsed = new uint8_t[6];
-	std::stringstream converter;
-	uint temp;
+	// The number of hex digits between two separators.
+	uint8_t group;
+	switch (strnlen(mac, 18)) {
+	case 12:
+		group = 12;
+		break;
+	case 14:
+		group = 4;
+		break;
+	case 17:
+		group = 2;
+		break;
+	default:
+		return false;
+	}
+
+	const char separator = mac[group % 12];
+	if ((group == 4 && separator != '.')
+			|| (group == 2 && separator != ':' && separator != '-')) {
+		return false;
+	}
+
+	MacAddress result;
+	for (uint8_t i = 0; i < 12; i++) {
+		if (i != 0 && i % group == 0 && *mac++ != separator) {
+			return false;
+		}
+
+		const uint8_t digit = kHexDigits[(uint8_t) *mac++];
+		if (digit > 0x0F) {
+			return false;
+		}
+
+		if (i & 1) {
+			result[i / 2] |= digit;
+		} else {
+			result[i / 2] = digit << 4;
+		}
+	}
+
+	parsed = result;
+	return true;
+}
+
+size_t WakeOnLanGenerator::buildEthernetHeader(const MacAddress &destination,
+		const MacAddress &source, uint16_t vlan, uint8_t *header) {
+	size_t length = 0;
+	memcpy(header, destination.data(), 6);
+	memcpy(header + 6, source.data(), 6);
+	length += 12;
 
-	for (uint8_t i = 0; i < 6; i++) {
-		converter << mac[i * 3] << mac[i * 3 + 1];
-		converter >> std::hex >> temp;
-		parsed[i] = temp;
-		converter.str("");
-		converter.clear();
+	if (vlan != 0) {
+		header[length++] = 0x81;
+		header[length++] = 0x00;
+		header[length++] = (vlan >> 8) & 0x0F;
+		header[length++] = vlan & 0xFF;
 	}
 
-	return parsed;
+	header[length++] = kEtherType >> 8;
+	header[length++] = kEtherType & 0xFF;
+	return length;
 }
@@ -11,7 +11,11 @@
 #ifndef LIB_WAKEONLANGENERATOR_H_
 #define LIB_WAKEONLANGENERATOR_H_
 
-#include <regex>
+#include <algorithm>
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
 #ifdef ESP32
 #include <WiFi.h>
 #include <AsyncUDP.h>
@@ -20,12 +24,66 @@
 #include <ESPAsyncUDP.h>
 #endif
 
-static const std::regex MAC_REGEX(
-		"[a-fA-F0-9]{2}:[a-fA-F0-9]{2}:[a-fA-F0-9]{2}:[a-fA-F0-9]{2}:[a-fA-F0-9]{2}:[a-fA-F0-9]{2}");
+/*
+ * A mac address in network byte order.
+ */
+typedef std::array<uint8_t, 6> MacAddress;
 
 class WakeOnLanGenerator {
 public:
 
+	/*
+	 * The size of a Wake on Lan magic packet in bytes.
+	 */
+	static const size_t kMagicPacketSize = 6 + 16 * 6;
+
+	/*
+	 * The size of a SecureOn password appended to a magic packet.
+	 */
+	static const size_t kSecureOnSize = 6;
+
+	/*
+	 * The EtherType of raw Wake on Lan frames.
+	 */
+	static const uint16_t kEtherType = 0x0842;
+
+	/*
+	 * The size of an untagged Ethernet header.
+	 */
+	static const size_t kEthernetHeaderSize = 14;
+
+	/*
+	 * The size of an 802.1Q VLAN tag.
+	 */
+	static const size_t kVlanTagSize = 4;
+
+	/*
+	 * Writes the magic packet for the given target mac address to packet,
+	 * which has to hold at least kMagicPacketSize bytes.
+	 */
+	static void buildMagicPacket(const MacAddress &target, uint8_t *packet);
+
+	/*
+	 * Writes the magic packet for the given target mac address followed by
+	 * the given SecureOn password to packet, which has to hold at least
+	 * kMagicPacketSize + kSecureOnSize bytes.
+	 */
+	static void buildMagicPacket(const MacAddress &target,
+			const MacAddress &password, uint8_t *packet) {
+		buildMagicPacket(target, packet);
+		std::copy(password.begin(), password.end(), packet + kMagicPacketSize);
+	}
+
+	/*
+	 * Writes the Ethernet header of a raw Wake on Lan frame to header.
+	 * A vlan id from 1 to 4094 adds an 802.1Q tag, 0 leaves the frame untagged.
+	 * Returns the number of bytes written, kEthernetHeaderSize plus
+	 * kVlanTagSize for tagged frames.
+	 */
+	static size_t buildEthernetHeader(const MacAddress &destination,
+			const MacAddress &source, uint16_t vlan, uint8_t *header);
+
+#if defined(ESP32) || defined(ESP8266)
 	/*
 	 * Generates a Wake on Lan packet for the given target mac address.
 	 */
@@ -35,35 +93,51 @@ public:
 
 	/*
 	 * Generates a Wake on Lan packet for the given target mac address.
+	 * Returns an empty message if given an invalid mac address.
 	 */
 	static AsyncUDPMessage generateWoLPacket(const char *targetMac);
+#endif
 
 	/*
 	 * Parses the given mac address from a string to an array of 6 bytes.
-	 * Returns NULL if given an invalid mac address.
+	 * Returns false, and leaves parsed untouched, if given an invalid mac address.
 	 */
-	static const uint8_t* parseMacAddr(const std::string &mac) {
-		return parseMacAddr(mac.c_str());
+	static bool parseMacAddr(const std::string &mac, MacAddress &parsed) {
+		return parseMacAddr(mac.c_str(), parsed);
 	}
 
 	/*
 	 * Parses the given mac address from a string to an array of 6 bytes.
-	 * Returns NULL if given an invalid mac address.
+	 * Accepts the colon (00:1a:2b:3c:4d:5e), dash (00-1a-2b-3c-4d-5e),
+	 * Cisco dotted (001a.2b3c.4d5e) and bare hex (001a2b3c4d5e) notations.
+	 * Returns false, and leaves parsed untouched, if given an invalid mac address.
 	 */
-	static const uint8_t* parseMacAddr(const char *mac);
+	static bool parseMacAddr(const char *mac, MacAddress &parsed);
+
+	/*
+	 * Packs a mac address into the lower 48 bits of an integer.
+	 */
+	static uint64_t packMacAddr(const MacAddress &mac) {
+		uint64_t packed = 0;
+		for (uint8_t i = 0; i < 6; i++) {
+			packed = (packed << 8) | mac[i];
+		}
+		return packed;
+	}
 
 	/*
 	 * Checks whether the given string is a valid mac address.
 	 */
-	static const bool isValidMac(const std::string &mac) {
+	static bool isValidMac(const std::string &mac) {
 		return isValidMac(mac.c_str());
 	}
 
 	/*
 	 * Checks whether the given string is a valid mac address.
 	 */
-	static const bool isValidMac(const char *mac) {
-		return std::regex_match(mac, MAC_REGEX);
+	static bool isValidMac(const char *mac) {
+		MacAddress parsed;
+		return parseMacAddr(mac, parsed);
 	}
 };
 
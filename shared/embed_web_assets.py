@@ -0,0 +1,130 @@
+#!/usr/bin/python
+# Minifies and gzips the web assets in data/ into include/WebAssets.h, so the
+# web server can serve them from flash instead of the SD card.
+# Templates are stored minified but uncompressed, they are expanded per
+# request, as are files gzip doesn't shrink. Runs as a pre script, or
+# standalone from the project root.
+import gzip
+import hashlib
+import os
+import re
+
+try:
+    Import("env")
+    project_dir = env.subst("$PROJECT_DIR")
+except NameError:
+    project_dir = os.getcwd()
+
+DATA_DIR = "data"
+OUTPUT = os.path.join("include", "WebAssets.h")
+TEMPLATES = {"index.html"}
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".png": "image/png",
+    ".js": "application/javascript",
+}
+
+
+def minify_html(text):
+    # Line breaks are kept, they may end a // comment in a script
+    lines = (line.strip() for line in text.splitlines())
+    return "\n".join(line for line in lines if line)
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{}:;,>])\s*", r"\1", text)
+    return text.replace(";}", "}").strip()
+
+
+def minify(name, data):
+    if name.endswith(".html"):
+        return minify_html(data.decode("utf-8")).encode("utf-8")
+    if name.endswith(".css"):
+        return minify_css(data.decode("utf-8")).encode("utf-8")
+    return data
+
+
+def identifier(name):
+    parts = re.split(r"[^A-Za-z0-9]", name)
+    return "k" + "".join(part.capitalize() for part in parts if part)
+
+
+def byte_array(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    data_dir = os.path.join(project_dir, DATA_DIR)
+    arrays = []
+    entries = []
+    for name in sorted(os.listdir(data_dir)):
+        path = os.path.join(data_dir, name)
+        extension = os.path.splitext(name)[1]
+        if not os.path.isfile(path) or extension not in CONTENT_TYPES:
+            continue
+        with open(path, "rb") as f:
+            raw = f.read()
+        data = minify(name, raw)
+        template = name in TEMPLATES
+        compressed = False
+        if template:
+            data += b"\0"  # sent as a string through the template processor
+        else:
+            # mtime 0 keeps the output, and so the ETag, reproducible
+            gzipped = gzip.compress(data, 9, mtime=0)
+            compressed = len(gzipped) < len(data)
+            if compressed:
+                data = gzipped
+        etag = '\\"%s\\"' % hashlib.sha1(data).hexdigest()[:16]
+        array = identifier(name)
+        arrays.append("constexpr uint8_t %s[] = {\n%s\n};\n" % (array, byte_array(data)))
+        entries.append('    {"/%s", "%s", %s, sizeof(%s)%s, %s, %s, "%s"},' % (
+            name, CONTENT_TYPES[extension], array, array,
+            " - 1" if template else "", "true" if compressed else "false",
+            "true" if template else "false", etag))
+        print("Web asset %s: %u -> %u bytes" % (name, len(raw), len(data)))
+
+    header = """#ifndef INCLUDE_WEBASSETS_H_
+#define INCLUDE_WEBASSETS_H_
+
+// Generated by shared/embed_web_assets.py from data/, do not edit.
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct WebAsset {
+  const char *path;
+  const char *content_type;
+  const uint8_t *data;
+  size_t size;
+  bool gzip;
+  bool is_template;  // plain text with placeholders, never gzipped
+  const char *etag;
+};
+
+%s
+constexpr WebAsset kWebAssets[] = {
+%s
+};
+
+constexpr size_t kWebAssetCount = sizeof(kWebAssets) / sizeof(kWebAssets[0]);
+
+#endif  // INCLUDE_WEBASSETS_H_
+""" % ("\n".join(arrays), "\n".join(entries))
+
+    output = os.path.join(project_dir, OUTPUT)
+    # Only touch the header if it changed, so it doesn't trigger a rebuild
+    if os.path.exists(output):
+        with open(output) as f:
+            if f.read() == header:
+                return
+    with open(output, "w") as f:
+        f.write(header)
+
+main()
@@ -0,0 +1,54 @@
+#!/usr/bin/python
+# Prints the loop() duration histogram of a time window as a bar chart, from
+# two scrapes of /metrics. Run it against two builds to compare them:
+#   loop_histogram.py http://wol.zs.home user password [seconds]
+import base64
+import re
+import sys
+import time
+import urllib.request
+
+BUCKET = re.compile(r'^wol_loop_duration_seconds_bucket\{le="([^"]+)"\} (\d+)$')
+
+
+def scrape(url, user, password):
+    request = urllib.request.Request(url.rstrip("/") + "/metrics")
+    credentials = base64.b64encode(f"{user}:{password}".encode()).decode()
+    request.add_header("Authorization", "Basic " + credentials)
+    with urllib.request.urlopen(request, timeout=10) as response:
+        lines = response.read().decode().splitlines()
+    buckets = []
+    for line in lines:
+        match = BUCKET.match(line)
+        if match:
+            buckets.append((match.group(1), int(match.group(2))))
+    return buckets
+
+
+def main():
+    if len(sys.argv) < 4:
+        print(f"Usage: {sys.argv[0]} url user password [seconds]")
+        sys.exit(1)
+    url, user, password = sys.argv[1:4]
+    seconds = int(sys.argv[4]) if len(sys.argv) > 4 else 60
+
+    before = scrape(url, user, password)
+    time.sleep(seconds)
+    after = scrape(url, user, password)
+
+    # The buckets are cumulative, the bars show each one on its own
+    counts = []
+    previous = 0
+    for (le, start), (_, end) in zip(before, after):
+        cumulative = end - start
+        counts.append((le, cumulative - previous))
+        previous = cumulative
+    total = previous
+    print(f"{total} loop runs in {seconds} s")
+    widest = max((count for _, count in counts), default=0)
+    for le, count in counts:
+        bar = "#" * (50 * count // widest if widest else 0)
+        print(f"<= {le:>8} s {count:>9} {bar}")
+
+
+main()
@@ -0,0 +1,128 @@
+/*
+ *
+ * Buttons.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "Buttons.h"
+
+// Read from the interrupt handler, so kept in RAM
+DRAM_ATTR const uint8_t Buttons::kPins[kButtonCount] = {
+    BUTTON_UP, BUTTON_DOWN, BUTTON_HASH, BUTTON_STAR};
+int64_t Buttons::pressed_at_[kButtonCount] = {};
+int64_t Buttons::last_edge_[kButtonCount] = {};
+std::atomic<uint8_t> Buttons::unsettled_(0);
+portMUX_TYPE Buttons::mux_ = portMUX_INITIALIZER_UNLOCKED;
+ButtonEvent Buttons::events_[BUTTON_EVENTS];
+std::atomic<uint8_t> Buttons::head_(0);
+std::atomic<uint8_t> Buttons::tail_(0);
+TaskHandle_t Buttons::waiter_ = nullptr;
+
+void Buttons::Setup() {
+  waiter_ = xTaskGetCurrentTaskHandle();
+  for (uint8_t button = 0; button < kButtonCount; ++button) {
+    pinMode(kPins[button], INPUT_PULLUP);  // pressed pulls the pin low
+    attachInterruptArg(kPins[button], OnEdge,
+                       reinterpret_cast<void *>(button), CHANGE);
+  }
+}
+
+bool Buttons::Read(ButtonEvent &event) {
+  Settle();
+  const uint8_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail == head_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  event = events_[tail];
+  tail_.store((tail + 1) % BUTTON_EVENTS, std::memory_order_release);
+  return true;
+}
+
+void Buttons::Wait(uint32_t timeout_ms) {
+  if (tail_.load(std::memory_order_relaxed) !=
+      head_.load(std::memory_order_acquire)) {
+    return;
+  }
+  if (unsettled_.load(std::memory_order_relaxed) != 0 &&
+      timeout_ms > BUTTON_DEBOUNCE_MS) {
+    timeout_ms = BUTTON_DEBOUNCE_MS;  // for Read() to settle them
+  }
+  // An event written since the check has already given the notification
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms));
+}
+
+// Takes the edges the debounce window held back, once it is over. The held
+// time of such a release runs up to the call.
+void Buttons::Settle() {
+  if (unsettled_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  const int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&mux_);
+  for (uint8_t button = 0; button < kButtonCount; ++button) {
+    const uint8_t unsettled = unsettled_.load(std::memory_order_relaxed);
+    const uint8_t bit = 1 << button;
+    if ((unsettled & bit) != 0 &&
+        now - last_edge_[button] >= BUTTON_DEBOUNCE_MS * 1000LL) {
+      unsettled_.store(unsettled & ~bit, std::memory_order_relaxed);
+      TakeEdge(button, now);
+    }
+  }
+  portEXIT_CRITICAL(&mux_);
+}
+
+void IRAM_ATTR Buttons::OnEdge(void *arg) {
+  const uint8_t button = reinterpret_cast<uintptr_t>(arg);
+  const int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL_ISR(&mux_);
+  const bool queued = TakeEdge(button, now);
+  portEXIT_CRITICAL_ISR(&mux_);
+  if (queued && waiter_ != nullptr) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(waiter_, &woken);
+    if (woken == pdTRUE) {
+      portYIELD_FROM_ISR();
+    }
+  }
+}
+
+// Takes the state of the pin if it differs from the one taken last. Called
+// with mux_ held, returns true if an event was queued.
+bool IRAM_ATTR Buttons::TakeEdge(uint8_t button, int64_t now) {
+  const bool down = digitalRead(kPins[button]) == LOW;
+  if (down == (pressed_at_[button] != 0)) {
+    return false;  // bounced back to the state already taken
+  }
+  if (now - last_edge_[button] < BUTTON_DEBOUNCE_MS * 1000LL) {
+    // Bouncing, or a real edge in quick succession. Settle() looks again.
+    unsettled_.store(unsettled_.load(std::memory_order_relaxed) | 1 << button,
+                     std::memory_order_relaxed);
+    return false;
+  }
+  last_edge_[button] = now;
+  if (down) {
+    pressed_at_[button] = now;
+    return false;
+  }
+  const uint32_t held = (now - pressed_at_[button]) / 1000;
+  pressed_at_[button] = 0;
+
+  const uint8_t head = head_.load(std::memory_order_relaxed);
+  const uint8_t next = (head + 1) % BUTTON_EVENTS;
+  if (next == tail_.load(std::memory_order_acquire)) {
+    return false;  // full
+  }
+  events_[head].button = static_cast<ButtonId>(button);
+  events_[head].long_press = held >= BUTTON_LONG_PRESS_MS;
+  events_[head].held = held;
+  head_.store(next, std::memory_order_release);
+  return true;
+}
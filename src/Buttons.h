@@ -0,0 +1,82 @@
+#ifndef SRC_BUTTONS_H_
+#define SRC_BUTTONS_H_
+
+/*
+ *
+ * Buttons.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+The four buttons next to the display, read by GPIO interrupts instead of
+polling. The interrupt handler debounces each edge against the time of the
+last one it took, and on release puts an event with the time the button was
+held into a ring. An edge within the debounce window is not taken, the
+button is only marked unsettled. Read() samples its pin again once the
+window is over and takes the edge then, so a release that came early isn't
+lost. Both take edges under the same lock, the Arduino loop is the only
+consumer. Events are dropped while the ring is full.
+*/
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#define BUTTON_UP 36
+#define BUTTON_DOWN 39
+#define BUTTON_HASH 34
+#define BUTTON_STAR 35
+#define BUTTON_DEBOUNCE_MS 50
+#define BUTTON_LONG_PRESS_MS 800
+#define BUTTON_EVENTS 16
+
+enum ButtonId : uint8_t {
+  kButtonUp,
+  kButtonDown,
+  kButtonHash,
+  kButtonStar,
+  kButtonCount
+};
+
+struct ButtonEvent {
+  ButtonId button;
+  bool long_press;  // held for BUTTON_LONG_PRESS_MS or longer
+  uint32_t held;    // ms
+};
+
+class Buttons {
+ public:
+  // Attaches the interrupts. Wait() wakes up the calling task.
+  static void Setup();
+  // Takes the oldest event. Returns false if there is none.
+  static bool Read(ButtonEvent &event);
+  // Sleeps until an event arrives or for timeout_ms, returns right away if
+  // there are events left to read. Sleeps at most BUTTON_DEBOUNCE_MS while a
+  // button is unsettled.
+  static void Wait(uint32_t timeout_ms);
+
+ private:
+  static void IRAM_ATTR OnEdge(void *button);
+  static bool IRAM_ATTR TakeEdge(uint8_t button, int64_t now);
+  static void Settle();
+
+  static const uint8_t kPins[kButtonCount];
+  static int64_t pressed_at_[kButtonCount];  // us, 0 while released
+  static int64_t last_edge_[kButtonCount];   // us
+  static std::atomic<uint8_t> unsettled_;     // bit n for button n
+  static portMUX_TYPE mux_;                   // edges and unsettled_
+  static ButtonEvent events_[BUTTON_EVENTS];
+  static std::atomic<uint8_t> head_;  // next event to write
+  static std::atomic<uint8_t> tail_;  // next event to read
+  static TaskHandle_t waiter_;
+};
+
+#endif /* SRC_BUTTONS_H_ */
@@ -0,0 +1,393 @@
+/*
+ *
+ * ConfigCache.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "ConfigCache.h"
+
+#include <esp_rom_crc.h>
+
+#include <algorithm>
+
+// Header, all fields little endian:
+//   uint32 magic, uint16 version, uint16 reserved,
+//   uint32 yaml_hash, uint32 payload_size, uint32 payload_crc
+// The payload follows, strings are stored as uint16 length and bytes, lists
+// as uint16 count and entries.
+
+static const size_t kBufferSize = 256;
+static const size_t kMinDeviceSize = 34;  // a device with empty strings
+
+// Reads the payload through a small buffer. Every read is checked against
+// the payload size, a short or corrupted file fails the reader and returns
+// zeros instead of reading past the end.
+class CacheReader {
+ public:
+  CacheReader(fs::File &file, uint32_t size)
+      : file_(file), remaining_(size), unread_(size) {}
+
+  bool ok() const { return ok_; }
+  uint32_t remaining() const { return remaining_; }
+  uint32_t crc() const { return crc_; }
+  void Fail() { ok_ = false; }
+
+  void Read(void *data, size_t length) {
+    uint8_t *out = static_cast<uint8_t *>(data);
+    if (!ok_ || length > remaining_) {
+      ok_ = false;
+      memset(out, 0, length);
+      return;
+    }
+    remaining_ -= length;
+    while (length > 0) {
+      if (pos_ == filled_ && !Fill()) {
+        ok_ = false;
+        memset(out, 0, length);
+        return;
+      }
+      size_t n = std::min(length, filled_ - pos_);
+      memcpy(out, buffer_ + pos_, n);
+      pos_ += n;
+      out += n;
+      length -= n;
+    }
+  }
+
+  uint8_t U8() {
+    uint8_t value;
+    Read(&value, 1);
+    return value;
+  }
+
+  uint16_t U16() {
+    uint8_t b[2];
+    Read(b, 2);
+    return b[0] | b[1] << 8;
+  }
+
+  uint32_t U32() {
+    uint8_t b[4];
+    Read(b, 4);
+    return b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+  }
+
+  void Str(String &str) {
+    uint16_t length = U16();
+    str = "";
+    if (length > remaining_) {
+      ok_ = false;
+      return;
+    }
+    str.reserve(length);
+    char chunk[64];
+    while (ok_ && length > 0) {
+      size_t n = std::min<size_t>(length, sizeof(chunk));
+      Read(chunk, n);
+      str.concat(chunk, n);
+      length -= n;
+    }
+  }
+
+  void Strings(std::vector<String> &list) {
+    uint16_t count = U16();
+    if (count > remaining_ / 2) {
+      ok_ = false;
+      return;
+    }
+    list.resize(count);
+    for (String &str : list) {
+      Str(str);
+    }
+  }
+
+ private:
+  bool Fill() {
+    size_t n = std::min<size_t>(sizeof(buffer_), unread_);
+    if (n == 0 || file_.read(buffer_, n) != n) {
+      return false;
+    }
+    crc_ = esp_rom_crc32_le(crc_, buffer_, n);
+    unread_ -= n;
+    pos_ = 0;
+    filled_ = n;
+    return true;
+  }
+
+  fs::File &file_;
+  uint8_t buffer_[kBufferSize];
+  size_t pos_ = 0;
+  size_t filled_ = 0;
+  uint32_t remaining_;  // payload bytes not consumed yet
+  uint32_t unread_;     // payload bytes not read from the file yet
+  uint32_t crc_ = 0;
+  bool ok_ = true;
+};
+
+// Writes the payload through a small buffer and keeps its size and CRC.
+class CacheWriter {
+ public:
+  explicit CacheWriter(fs::File &file) : file_(file) {}
+
+  bool ok() const { return ok_; }
+  uint32_t size() const { return size_; }
+  uint32_t crc() const { return crc_; }
+
+  void Write(const void *data, size_t length) {
+    const uint8_t *in = static_cast<const uint8_t *>(data);
+    size_ += length;
+    while (length > 0) {
+      if (filled_ == sizeof(buffer_)) {
+        Flush();
+      }
+      size_t n = std::min(length, sizeof(buffer_) - filled_);
+      memcpy(buffer_ + filled_, in, n);
+      filled_ += n;
+      in += n;
+      length -= n;
+    }
+  }
+
+  void U8(uint8_t value) { Write(&value, 1); }
+
+  void U16(uint16_t value) {
+    uint8_t b[2] = {(uint8_t)value, (uint8_t)(value >> 8)};
+    Write(b, 2);
+  }
+
+  void U32(uint32_t value) {
+    uint8_t b[4] = {(uint8_t)value, (uint8_t)(value >> 8),
+                    (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+    Write(b, 4);
+  }
+
+  void Str(const String &str) {
+    size_t length = std::min<size_t>(str.length(), 0xFFFF);
+    U16(length);
+    Write(str.c_str(), length);
+  }
+
+  void Strings(const std::vector<String> &list) {
+    size_t count = std::min<size_t>(list.size(), 0xFFFF);
+    U16(count);
+    for (size_t i = 0; i < count; ++i) {
+      Str(list[i]);
+    }
+  }
+
+  void Flush() {
+    if (filled_ > 0) {
+      crc_ = esp_rom_crc32_le(crc_, buffer_, filled_);
+      ok_ = ok_ && file_.write(buffer_, filled_) == filled_;
+      filled_ = 0;
+    }
+  }
+
+ private:
+  fs::File &file_;
+  uint8_t buffer_[kBufferSize];
+  size_t filled_ = 0;
+  uint32_t size_ = 0;
+  uint32_t crc_ = 0;
+  bool ok_ = true;
+};
+
+static void WriteHeader(uint8_t *header, uint32_t yaml_hash,
+                        uint32_t payload_size, uint32_t payload_crc) {
+  const uint32_t words[] = {ConfigCache::kMagic, ConfigCache::kVersion,
+                            yaml_hash, payload_size, payload_crc};
+  for (size_t i = 0; i < 5; ++i) {
+    for (size_t b = 0; b < 4; ++b) {
+      header[i * 4 + b] = words[i] >> (8 * b);
+    }
+  }
+}
+
+static uint32_t HeaderWord(const uint8_t *header, size_t index) {
+  const uint8_t *b = header + index * 4;
+  return b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+static void WriteConfig(CacheWriter &writer, const NetworkConfig &config) {
+  writer.U32(config.ip);
+  writer.U32(config.gateway);
+  writer.U32(config.subnet);
+  writer.U32(config.dns);
+  writer.Str(config.ntp1);
+  writer.Str(config.ntp2);
+  writer.Str(config.hostname);
+  writer.Str(config.timezone);
+  writer.Str(config.ota_password);
+  writer.U16(config.wol_startup);
+  writer.U16(config.wol_repeat);
+  writer.U16(config.wol_port);
+  writer.U16(config.wol_rate);
+  writer.U16(config.wol_burst);
+  writer.U8(config.wol_raw);
+  writer.U16(config.probe_backoff);
+  writer.U16(config.probe_max_backoff);
+  writer.U16(config.probe_timeout);
+  writer.U16(config.max_concurrent_boots);
+  writer.U16(config.boot_timeout);
+  writer.U16(config.wol_quiet_window);
+  writer.U8(config.web_enabled);
+  writer.Str(config.web_user);
+  writer.Write(&config.web_password_hash, sizeof(config.web_password_hash));
+  writer.U16(config.web_rate);
+  writer.U16(config.web_burst);
+}
+
+static void ReadConfig(CacheReader &reader, NetworkConfig &config) {
+  config.ip = reader.U32();
+  config.gateway = reader.U32();
+  config.subnet = reader.U32();
+  config.dns = reader.U32();
+  reader.Str(config.ntp1);
+  reader.Str(config.ntp2);
+  reader.Str(config.hostname);
+  reader.Str(config.timezone);
+  reader.Str(config.ota_password);
+  config.wol_startup = reader.U16();
+  config.wol_repeat = reader.U16();
+  config.wol_port = reader.U16();
+  config.wol_rate = reader.U16();
+  config.wol_burst = reader.U16();
+  config.wol_raw = reader.U8();
+  config.probe_backoff = reader.U16();
+  config.probe_max_backoff = reader.U16();
+  config.probe_timeout = reader.U16();
+  config.max_concurrent_boots = reader.U16();
+  config.boot_timeout = reader.U16();
+  config.wol_quiet_window = reader.U16();
+  config.web_enabled = reader.U8();
+  reader.Str(config.web_user);
+  reader.Read(&config.web_password_hash, sizeof(config.web_password_hash));
+  config.web_rate = reader.U16();
+  config.web_burst = reader.U16();
+}
+
+static void WriteDevice(CacheWriter &writer, const WolDevice &device) {
+  writer.Str(device.mac);
+  writer.Str(device.name);
+  writer.U16(device.vlan);
+  writer.U32(device.target_ip);
+  writer.U16(device.port);
+  writer.U8(device.has_secureon);
+  writer.Write(device.secureon.data(), device.secureon.size());
+  writer.U32(device.probe.ip);
+  writer.U16(device.probe.tcp_port);
+  writer.U8(device.probe.type);
+  writer.Strings(device.depends_on);
+  writer.U16(device.priority);
+  writer.Str(device.group);
+  writer.Strings(device.tags);
+}
+
+static void ReadDevice(CacheReader &reader, WolDevice &device) {
+  reader.Str(device.mac);
+  reader.Str(device.name);
+  device.vlan = reader.U16();
+  device.target_ip = reader.U32();
+  device.port = reader.U16();
+  device.has_secureon = reader.U8();
+  reader.Read(device.secureon.data(), device.secureon.size());
+  device.probe.ip = reader.U32();
+  device.probe.tcp_port = reader.U16();
+  uint8_t type = reader.U8();
+  if (type > kProbeTcp) {
+    reader.Fail();
+  }
+  device.probe.type = static_cast<ProbeType>(type);
+  reader.Strings(device.depends_on);
+  device.priority = reader.U16();
+  reader.Str(device.group);
+  reader.Strings(device.tags);
+}
+
+uint32_t ConfigCache::HashFile(fs::File &file) {
+  uint8_t buffer[kBufferSize];
+  uint32_t crc = 0;
+  size_t n;
+  while ((n = file.read(buffer, sizeof(buffer))) > 0) {
+    crc = esp_rom_crc32_le(crc, buffer, n);
+  }
+  return crc;
+}
+
+bool ConfigCache::Load(fs::FS &fs, const char *path, uint32_t yaml_hash,
+                       NetworkConfig &config, std::vector<WolDevice> &devices) {
+  fs::File file = fs.open(path, FILE_READ);
+  if (!file) {
+    return false;
+  }
+  uint8_t header[kHeaderSize];
+  if (file.read(header, kHeaderSize) != kHeaderSize ||
+      HeaderWord(header, 0) != kMagic || HeaderWord(header, 1) != kVersion ||
+      HeaderWord(header, 2) != yaml_hash ||
+      HeaderWord(header, 3) != file.size() - kHeaderSize) {
+    file.close();
+    return false;
+  }
+
+  CacheReader reader(file, HeaderWord(header, 3));
+  NetworkConfig cached_config;
+  std::vector<WolDevice> cached_devices;
+  ReadConfig(reader, cached_config);
+  uint32_t count = reader.U32();
+  if (count > reader.remaining() / kMinDeviceSize) {
+    reader.Fail();
+  } else {
+    cached_devices.resize(count);
+  }
+  for (WolDevice &device : cached_devices) {
+    ReadDevice(reader, device);
+  }
+  file.close();
+  if (!reader.ok() || reader.remaining() != 0 ||
+      reader.crc() != HeaderWord(header, 4)) {
+    return false;
+  }
+  config = std::move(cached_config);
+  devices = std::move(cached_devices);
+  return true;
+}
+
+bool ConfigCache::Store(fs::FS &fs, const char *path, uint32_t yaml_hash,
+                        const NetworkConfig &config,
+                        const std::vector<WolDevice> &devices) {
+  String temp_path = String(path) + ".tmp";
+  fs::File file = fs.open(temp_path, FILE_WRITE);
+  if (!file) {
+    return false;
+  }
+  // Reserve the header, it is written once size and CRC are known
+  uint8_t header[kHeaderSize] = {};
+  bool ok = file.write(header, kHeaderSize) == kHeaderSize;
+
+  CacheWriter writer(file);
+  WriteConfig(writer, config);
+  writer.U32(devices.size());
+  for (const WolDevice &device : devices) {
+    WriteDevice(writer, device);
+  }
+  writer.Flush();
+
+  WriteHeader(header, yaml_hash, writer.size(), writer.crc());
+  ok = ok && writer.ok() && file.seek(0) &&
+       file.write(header, kHeaderSize) == kHeaderSize;
+  file.close();
+  if (!ok) {
+    fs.remove(temp_path.c_str());
+    return false;
+  }
+  fs.remove(path);
+  return fs.rename(temp_path.c_str(), path);
+}
@@ -0,0 +1,52 @@
+#ifndef SRC_CONFIGCACHE_H_
+#define SRC_CONFIGCACHE_H_
+
+/*
+ *
+ * ConfigCache.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Binary cache of the parsed config. It holds NetworkConfig and the device
+list in a compact versioned format, keyed by a CRC32 of the YAML file it
+was built from, so an unchanged config.yml does not have to be parsed
+again on boot. The reader checks every field against the payload size from
+the header and the payload against its CRC, any mismatch is a cache miss.
+The web password is stored as its salted hash, never in plaintext.
+*/
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include <vector>
+
+#include "ConfigLoader.h"
+
+class ConfigCache {
+ public:
+  static const uint32_t kMagic = 0x434C4F57;  // "WOLC"
+  // Bump whenever the payload layout, NetworkConfig or WolDevice changes.
+  static const uint16_t kVersion = 3;
+  static const size_t kHeaderSize = 20;
+
+  // Returns the CRC32 of the remaining contents of file.
+  static uint32_t HashFile(fs::File &file);
+  // Loads config and devices from the cache at path, if it was built from a
+  // YAML file with the hash yaml_hash. Leaves both untouched otherwise.
+  static bool Load(fs::FS &fs, const char *path, uint32_t yaml_hash,
+                   NetworkConfig &config, std::vector<WolDevice> &devices);
+  static bool Store(fs::FS &fs, const char *path, uint32_t yaml_hash,
+                    const NetworkConfig &config,
+                    const std::vector<WolDevice> &devices);
+};
+
+#endif /* SRC_CONFIGCACHE_H_ */
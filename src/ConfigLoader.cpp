@@ -0,0 +1,564 @@
+/*
+ *
+ * ConfigLoader.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "ConfigLoader.h"
+
+#include <ctype.h>
+#include <libyaml/yaml.h>
+#include <lwip/sockets.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#include <algorithm>
+
+#include "DeviceTable.h"
+
+enum FieldType : uint8_t {
+  kTypeIp,
+  kTypeString,
+  kTypeNumber,
+  kTypeBool,
+  kTypeTransport,  // "udp" or "ethernet", stored as wol_raw
+};
+
+enum FieldId : uint8_t {
+  kFieldIp,
+  kFieldGateway,
+  kFieldNetmask,
+  kFieldDns,
+  kFieldHostname,
+  kFieldNtp1,
+  kFieldNtp2,
+  kFieldTimezone,
+  kFieldOtaPassword,
+  kFieldWolStartup,
+  kFieldWolRepeat,
+  kFieldWolPort,
+  kFieldWolRate,
+  kFieldWolBurst,
+  kFieldWolTransport,
+  kFieldMaxConcurrentBoots,
+  kFieldBootTimeout,
+  kFieldWolQuietWindow,
+  kFieldProbeBackoff,
+  kFieldProbeMaxBackoff,
+  kFieldProbeTimeout,
+  kFieldWebEnabled,
+  kFieldWebUser,
+  kFieldWebPassword,
+  kFieldWebRate,
+  kFieldWebBurst,
+  kFieldCount
+};
+
+struct ConfigField {
+  const char *path;  // "section:key", or "key" at the top level
+  FieldType type;
+  bool required;
+  uint16_t min;  // range of numbers
+  uint16_t max;
+  uint16_t def;  // default of optional numbers
+};
+
+// Must be in the order of FieldId.
+static const ConfigField kSchema[kFieldCount] = {
+    {"network:ip", kTypeIp, true, 0, 0, 0},
+    {"network:gateway", kTypeIp, true, 0, 0, 0},
+    {"network:netmask", kTypeIp, true, 0, 0, 0},
+    {"network:DNS", kTypeIp, true, 0, 0, 0},
+    {"network:hostname", kTypeString, true, 0, 0, 0},
+    {"network:NTP1", kTypeString, true, 0, 0, 0},
+    {"network:NTP2", kTypeString, false, 0, 0, 0},
+    {"timezone", kTypeString, true, 0, 0, 0},
+    {"ota_password_hash", kTypeString, true, 0, 0, 0},
+    {"wol:startup", kTypeNumber, true, 0, 65535, 0},
+    {"wol:repeat", kTypeNumber, true, 0, 65535, 0},
+    {"wol:port", kTypeNumber, true, 1, 65535, 0},
+    {"wol:rate", kTypeNumber, false, 1, 1000, kDefaultWolRate},
+    {"wol:burst", kTypeNumber, false, 1, 64, kDefaultWolBurst},
+    {"wol:transport", kTypeTransport, false, 0, 0, 0},
+    {"wol:max_concurrent_boots", kTypeNumber, false, 0, 65535, 0},
+    {"wol:boot_timeout", kTypeNumber, false, 1, 65535, kDefaultBootTimeout},
+    {"wol:quiet_window", kTypeNumber, false, 0, 65535,
+     kDefaultWolQuietWindow},
+    {"probe:backoff", kTypeNumber, false, 1, 65535, kDefaultProbeBackoff},
+    {"probe:max_backoff", kTypeNumber, false, 1, 65535,
+     kDefaultProbeMaxBackoff},
+    {"probe:timeout", kTypeNumber, false, 10, 10000, kDefaultProbeTimeout},
+    {"web:enabled", kTypeBool, true, 0, 0, 0},
+    {"web:user", kTypeString, false, 0, 0, 0},      // required if web:enabled
+    {"web:password", kTypeString, false, 0, 0, 0},  // required if web:enabled
+    {"web:rate", kTypeNumber, false, 1, 1000, kDefaultWebRate},
+    {"web:burst", kTypeNumber, false, 1, 1000, kDefaultWebBurst},
+};
+
+static_assert(kFieldCount <= 32, "seen is a 32 bit mask");
+
+// Binds the schema to the members of NetworkConfig.
+static void *FieldTarget(NetworkConfig &config, FieldId id) {
+  switch (id) {
+    case kFieldIp: return &config.ip;
+    case kFieldGateway: return &config.gateway;
+    case kFieldNetmask: return &config.subnet;
+    case kFieldDns: return &config.dns;
+    case kFieldHostname: return &config.hostname;
+    case kFieldNtp1: return &config.ntp1;
+    case kFieldNtp2: return &config.ntp2;
+    case kFieldTimezone: return &config.timezone;
+    case kFieldOtaPassword: return &config.ota_password;
+    case kFieldWolStartup: return &config.wol_startup;
+    case kFieldWolRepeat: return &config.wol_repeat;
+    case kFieldWolPort: return &config.wol_port;
+    case kFieldWolRate: return &config.wol_rate;
+    case kFieldWolBurst: return &config.wol_burst;
+    case kFieldWolTransport: return &config.wol_raw;
+    case kFieldMaxConcurrentBoots: return &config.max_concurrent_boots;
+    case kFieldBootTimeout: return &config.boot_timeout;
+    case kFieldWolQuietWindow: return &config.wol_quiet_window;
+    case kFieldProbeBackoff: return &config.probe_backoff;
+    case kFieldProbeMaxBackoff: return &config.probe_max_backoff;
+    case kFieldProbeTimeout: return &config.probe_timeout;
+    case kFieldWebEnabled: return &config.web_enabled;
+    case kFieldWebUser: return &config.web_user;
+    case kFieldWebPassword: return &config.web_password;
+    case kFieldWebRate: return &config.web_rate;
+    case kFieldWebBurst: return &config.web_burst;
+    default: return nullptr;
+  }
+}
+
+bool operator<(const WolDevice &left, const WolDevice &right) {
+  if (left.mac < right.mac) return true;
+
+  return false;
+}
+
+bool operator==(const WolDevice &left, const WolDevice &right) {
+  if (left.mac == right.mac) return true;
+
+  return false;
+}
+
+static const size_t kMaxDepth = 8;
+static const size_t kKeySize = 32;
+static const size_t kPathSize = 2 * kKeySize;
+
+// An open mapping or sequence. key is the current key of a mapping.
+struct ParseFrame {
+  bool mapping;
+  bool expect_key;  // the next scalar of a mapping is a key
+  char key[kKeySize];
+};
+
+struct ParseState {
+  NetworkConfig *config;
+  std::vector<WolDevice> *devices;
+  char *error;
+  ParseFrame stack[kMaxDepth];
+  size_t depth;
+  uint32_t seen;  // bit per FieldId
+  WolDevice device;  // the device being parsed
+  String host;
+  String probe;
+};
+
+// Parses a decimal integer in [min, max], without trailing garbage.
+static bool ParseNumber(const char *value, long min, long max, long &number) {
+  char *end;
+  number = strtol(value, &end, 10);
+  return end != value && *end == '\0' && number >= min && number <= max;
+}
+
+static bool ParseBool(const char *value, bool &flag) {
+  if (!strcasecmp(value, "true") || !strcasecmp(value, "yes")) {
+    flag = true;
+  } else if (!strcasecmp(value, "false") || !strcasecmp(value, "no")) {
+    flag = false;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static bool SetError(ParseState &state, const char *msg) {
+  strlcpy(state.error, msg, ConfigLoader::kErrorSize);
+  return false;
+}
+
+static bool AssignField(ParseState &state, FieldId id, const char *value) {
+  const ConfigField &field = kSchema[id];
+  void *target = FieldTarget(*state.config, id);
+  bool valid = true;
+  long number;
+  switch (field.type) {
+    case kTypeIp:
+      valid = static_cast<IPAddress *>(target)->fromString(value);
+      break;
+    case kTypeString:
+      *static_cast<String *>(target) = value;
+      break;
+    case kTypeNumber:
+      if (!ParseNumber(value, field.min, field.max, number)) {
+        snprintf(state.error, ConfigLoader::kErrorSize,
+                 "%s\nmust be %u-%u in\nYAML config.", field.path, field.min,
+                 field.max);
+        return false;
+      }
+      *static_cast<uint16_t *>(target) = number;
+      break;
+    case kTypeBool:
+      valid = ParseBool(value, *static_cast<bool *>(target));
+      break;
+    case kTypeTransport:
+      if (!strcmp(value, "ethernet")) {
+        *static_cast<bool *>(target) = true;
+      } else if (!strcmp(value, "udp")) {
+        *static_cast<bool *>(target) = false;
+      } else {
+        valid = false;
+      }
+      break;
+  }
+  if (!valid) {
+    snprintf(state.error, ConfigLoader::kErrorSize,
+             "Invalid %s\nin YAML config.", field.path);
+    return false;
+  }
+  state.seen |= 1UL << id;
+  return true;
+}
+
+static bool AssignPath(ParseState &state, const char *path, const char *value) {
+  for (uint8_t id = 0; id < kFieldCount; ++id) {
+    if (!strcmp(kSchema[id].path, path)) {
+      return AssignField(state, static_cast<FieldId>(id), value);
+    }
+  }
+  Serial.print("Ignoring unknown config key ");
+  Serial.println(path);
+  return true;
+}
+
+// Rows of the web interface are rendered into a fixed buffer sized for
+// names of up to DeviceTable::kMaxNameLength.
+static bool CheckNameLength(ParseState &state, const char *key,
+                            const char *value) {
+  if (strlen(value) > DeviceTable::kMaxNameLength) {
+    snprintf(state.error, ConfigLoader::kErrorSize,
+             "Device %s over\n%u chars in YAML\nconfig.", key,
+             static_cast<unsigned>(DeviceTable::kMaxNameLength));
+    return false;
+  }
+  return true;
+}
+
+// Handles a scalar of a device mapping, list_item is set for the entries of
+// a list below it.
+static bool AssignDevice(ParseState &state, const char *key, const char *value,
+                         bool list_item) {
+  WolDevice &device = state.device;
+  long number;
+  // depends_on and tags take a single value or a list
+  if (!strcmp(key, "depends_on")) {
+    if (*value) {
+      device.depends_on.push_back(value);
+    }
+  } else if (!strcmp(key, "tags")) {
+    device.tags.push_back(value);
+  } else if (list_item) {
+    return true;
+  } else if (!strcmp(key, "name")) {
+    if (!CheckNameLength(state, "name", value)) {
+      return false;
+    }
+    device.name = value;
+  } else if (!strcmp(key, "mac")) {
+    device.mac = value;
+  } else if (!strcmp(key, "vlan")) {
+    if (!ParseNumber(value, 0, 4094, number)) {
+      return SetError(state, "VLAN id must be\n0-4094 in YAML\nconfig.");
+    }
+    device.vlan = number;
+  } else if (!strcmp(key, "target")) {
+    if (!ConfigLoader::ParseWolTarget(value, device.target_ip)) {
+      return SetError(state, "Invalid device\ntarget in YAML\nconfig.");
+    }
+  } else if (!strcmp(key, "port")) {
+    if (!ParseNumber(value, 1, 65535, number)) {
+      return SetError(state, "Invalid device\nport in YAML\nconfig.");
+    }
+    device.port = number;
+  } else if (!strcmp(key, "secureon")) {
+    if (!WakeOnLanGenerator::parseMacAddr(value, device.secureon)) {
+      return SetError(state, "Invalid SecureOn\npassword in YAML\nconfig.");
+    }
+    device.has_secureon = true;
+  } else if (!strcmp(key, "host")) {
+    state.host = value;
+  } else if (!strcmp(key, "probe")) {
+    state.probe = value;
+  } else if (!strcmp(key, "priority")) {
+    if (!ParseNumber(value, INT16_MIN, INT16_MAX, number)) {
+      return SetError(state, "Invalid device\npriority in YAML\nconfig.");
+    }
+    device.priority = number;
+  } else if (!strcmp(key, "group")) {
+    if (!CheckNameLength(state, "group", value)) {
+      return false;
+    }
+    device.group = value;
+  } else {
+    Serial.print("Ignoring unknown device key ");
+    Serial.println(key);
+  }
+  return true;
+}
+
+static bool FinishDevice(ParseState &state) {
+  WolDevice &device = state.device;
+  if (device.name.isEmpty() || device.mac.isEmpty()) {
+    return SetError(state, "Device without\nname or mac in\nYAML config.");
+  }
+  if (!state.host.isEmpty()) {
+    IPAddress host_ip;
+    if (!host_ip.fromString(state.host) ||
+        !ConfigLoader::ParseProbe(state.probe.isEmpty() ? "icmp" : state.probe,
+                                  device.probe)) {
+      return SetError(state, "Invalid device\nhost or probe in\nYAML config.");
+    }
+    device.probe.ip = (uint32_t)host_ip;
+  }
+  state.devices->push_back(std::move(device));
+  return true;
+}
+
+// True if the frames up to depth 3 are devices: - {...}
+static bool InDevice(const ParseState &state) {
+  return state.depth >= 3 && state.stack[0].mapping &&
+         !strcmp(state.stack[0].key, "devices") && !state.stack[1].mapping &&
+         state.stack[2].mapping;
+}
+
+static bool OnValue(ParseState &state, const char *value) {
+  const ParseFrame *stack = state.stack;
+  if (state.depth == 1 && stack[0].mapping) {
+    return AssignPath(state, stack[0].key, value);
+  }
+  if (state.depth == 2 && stack[0].mapping && stack[1].mapping) {
+    char path[kPathSize];
+    snprintf(path, sizeof(path), "%s:%s", stack[0].key, stack[1].key);
+    return AssignPath(state, path, value);
+  }
+  if (InDevice(state) && state.depth <= 4) {
+    return AssignDevice(state, stack[2].key, value, state.depth == 4);
+  }
+  return true;  // not part of the schema
+}
+
+static bool Push(ParseState &state, bool mapping) {
+  if (state.depth == kMaxDepth) {
+    return SetError(state, "YAML config is\nnested too deep.");
+  }
+  ParseFrame &frame = state.stack[state.depth++];
+  frame.mapping = mapping;
+  frame.expect_key = true;
+  frame.key[0] = '\0';
+  if (state.depth == 3 && InDevice(state)) {
+    state.device = WolDevice();
+    state.host = "";
+    state.probe = "";
+  }
+  return true;
+}
+
+static bool Pop(ParseState &state) {
+  if (state.depth == 3 && InDevice(state) && !FinishDevice(state)) {
+    return false;
+  }
+  state.depth--;
+  if (state.depth > 0) {
+    state.stack[state.depth - 1].expect_key = true;
+  }
+  return true;
+}
+
+static bool HandleEvent(ParseState &state, const yaml_event_t &event) {
+  switch (event.type) {
+    case YAML_SCALAR_EVENT: {
+      if (state.depth == 0) {
+        return true;
+      }
+      const char *value = (const char *)event.data.scalar.value;
+      ParseFrame &top = state.stack[state.depth - 1];
+      if (top.mapping && top.expect_key) {
+        strlcpy(top.key, value, sizeof(top.key));
+        top.expect_key = false;
+        return true;
+      }
+      top.expect_key = true;
+      return OnValue(state, value);
+    }
+    case YAML_ALIAS_EVENT:
+      // Aliases are not resolved, skip them like an unknown value
+      if (state.depth > 0) {
+        ParseFrame &top = state.stack[state.depth - 1];
+        top.expect_key = !top.mapping || !top.expect_key;
+      }
+      return true;
+    case YAML_MAPPING_START_EVENT:
+      return Push(state, true);
+    case YAML_SEQUENCE_START_EVENT:
+      return Push(state, false);
+    case YAML_MAPPING_END_EVENT:
+    case YAML_SEQUENCE_END_EVENT:
+      return Pop(state);
+    default:
+      return true;
+  }
+}
+
+// Checks required keys and the constraints between keys.
+static bool CheckConfig(ParseState &state) {
+  for (uint8_t id = 0; id < kFieldCount; ++id) {
+    if (kSchema[id].required && !(state.seen & (1UL << id))) {
+      snprintf(state.error, ConfigLoader::kErrorSize, "No %s\nin YAML config.",
+               kSchema[id].path);
+      return false;
+    }
+  }
+  const NetworkConfig &config = *state.config;
+  if (config.web_enabled) {
+    if (config.web_user.isEmpty()) {
+      return SetError(state, "No web:user in\nYAML config.");
+    }
+    if (config.web_password.isEmpty()) {
+      return SetError(state, "No web:password\nin YAML config.");
+    }
+  }
+  if (config.probe_max_backoff < config.probe_backoff) {
+    return SetError(state,
+                    "Invalid probe\nbackoff or timeout\nin YAML config.");
+  }
+  if (state.devices->empty()) {
+    return SetError(state, "No target devices\nconfigured in\nYAML config.");
+  }
+  return true;
+}
+
+static int ReadFile(void *data, unsigned char *buffer, size_t size,
+                    size_t *size_read) {
+  *size_read = static_cast<fs::File *>(data)->read(buffer, size);
+  return 1;
+}
+
+bool ConfigLoader::Load(fs::File &file, NetworkConfig &config,
+                        std::vector<WolDevice> &devices, char *error,
+                        ConfigLoadStats *stats) {
+  const uint32_t start_us = micros();
+  const uint32_t start_heap = ESP.getFreeHeap();
+  uint32_t lowest_heap = start_heap;
+  uint32_t events = 0;
+
+  config = NetworkConfig();
+  for (uint8_t id = 0; id < kFieldCount; ++id) {
+    void *target = FieldTarget(config, static_cast<FieldId>(id));
+    if (kSchema[id].type == kTypeNumber) {
+      *static_cast<uint16_t *>(target) = kSchema[id].def;
+    } else if (kSchema[id].type == kTypeBool ||
+               kSchema[id].type == kTypeTransport) {
+      *static_cast<bool *>(target) = false;
+    }
+  }
+  devices.clear();
+  error[0] = '\0';
+
+  ParseState state;
+  state.config = &config;
+  state.devices = &devices;
+  state.error = error;
+  state.depth = 0;
+  state.seen = 0;
+
+  yaml_parser_t parser;
+  if (!yaml_parser_initialize(&parser)) {
+    return SetError(state, "Unable to start\nYAML parser.");
+  }
+  yaml_parser_set_input(&parser, ReadFile, &file);
+  bool ok = true;
+  bool done = false;
+  while (ok && !done) {
+    yaml_event_t event;
+    if (!yaml_parser_parse(&parser, &event)) {
+      snprintf(error, kErrorSize, "YAML syntax error\nin line %u.",
+               static_cast<unsigned>(parser.problem_mark.line + 1));
+      ok = false;
+      break;
+    }
+    events++;
+    lowest_heap = std::min(lowest_heap, ESP.getFreeHeap());
+    done = event.type == YAML_STREAM_END_EVENT;
+    ok = HandleEvent(state, event);
+    yaml_event_delete(&event);
+  }
+  yaml_parser_delete(&parser);
+  ok = ok && CheckConfig(state);
+
+  if (stats) {
+    stats->parse_us = micros() - start_us;
+    stats->peak_heap = start_heap - lowest_heap;
+    stats->events = events;
+  }
+  return ok;
+}
+
+bool ConfigLoader::ParseWolTarget(const String &target, uint32_t &ip) {
+  IPAddress address;
+  int slash = target.indexOf('/');
+  if (!address.fromString(slash < 0 ? target : target.substring(0, slash))) {
+    return false;
+  }
+  ip = (uint32_t)address;
+  if (slash >= 0) {
+    // Digits only, "24abc" is no prefix length
+    const char *prefix_str = target.c_str() + slash + 1;
+    long prefix;
+    if (!isdigit((unsigned char)*prefix_str) ||
+        !ParseNumber(prefix_str, 0, 32, prefix)) {
+      return false;
+    }
+    uint32_t mask = prefix ? 0xFFFFFFFFUL << (32 - prefix) : 0;
+    ip |= ~htonl(mask);
+  }
+  return ip != 0;
+}
+
+bool ConfigLoader::ParseProbe(const String &probe, ProbeTarget &target) {
+  if (probe == "icmp") {
+    target.type = kProbeIcmp;
+  } else if (probe == "arp") {
+    target.type = kProbeArp;
+  } else if (probe.startsWith("tcp:")) {
+    const char *port_str = probe.c_str() + 4;
+    long port;
+    if (!isdigit((unsigned char)*port_str) ||
+        !ParseNumber(port_str, 1, 65535, port)) {
+      return false;
+    }
+    target.type = kProbeTcp;
+    target.tcp_port = port;
+  } else {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,118 @@
+#ifndef SRC_CONFIGLOADER_H_
+#define SRC_CONFIGLOADER_H_
+
+/*
+ *
+ * ConfigLoader.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Single pass loader for the YAML config. The file is streamed through the
+libyaml event parser once, without building a document tree. Every scalar
+is dispatched on its path into a typed schema, which supplies the defaults
+and range checks of the config keys.
+*/
+
+#include <Arduino.h>
+#include <FS.h>
+#include <WakeOnLanGenerator.h>
+
+#include <vector>
+
+#include "ProbeEngine.h"
+#include "WebSession.h"
+
+static const uint16_t kDefaultWolRate = 20;  // packets per second
+static const uint16_t kDefaultWolBurst = 1;
+static const uint16_t kDefaultProbeBackoff = 10;      // s
+static const uint16_t kDefaultProbeMaxBackoff = 300;  // s
+static const uint16_t kDefaultProbeTimeout = 1000;    // ms
+static const uint16_t kDefaultBootTimeout = 300;      // s
+static const uint16_t kDefaultWolQuietWindow = 2000;  // ms
+static const uint16_t kDefaultWebRate = 5;            // requests per second
+static const uint16_t kDefaultWebBurst = 10;
+
+// Network config
+struct NetworkConfig {
+  IPAddress ip;
+  IPAddress gateway;
+  IPAddress subnet;
+  IPAddress dns;
+  String ntp1;
+  String ntp2;
+  String hostname;
+  String timezone;
+  String ota_password;
+  uint16_t wol_startup;
+  uint16_t wol_repeat;
+  uint16_t wol_port;
+  uint16_t wol_rate;
+  uint16_t wol_burst;
+  bool wol_raw;  // send raw Ethernet frames instead of UDP by default
+  uint16_t probe_backoff;      // s until the first probe after a wake
+  uint16_t probe_max_backoff;  // s
+  uint16_t probe_timeout;      // ms
+  uint16_t max_concurrent_boots;  // 0 for no limit
+  uint16_t boot_timeout;          // s
+  uint16_t wol_quiet_window;  // ms in which wakes of a device are joined
+  bool web_enabled;
+  String web_user;
+  String web_password;  // as parsed, cleared once hashed
+  WebSession::PasswordHash web_password_hash;
+  uint16_t web_rate;  // wake and login requests per second and client
+  uint16_t web_burst;
+};
+
+// Device information
+struct WolDevice {
+  String mac;
+  String name;
+  int16_t vlan = -1;  // -1 if not configured, 0 for untagged raw frames
+  uint32_t target_ip = 0;  // 0 for the local broadcast address
+  uint16_t port = 0;       // 0 for wol:port
+  bool has_secureon = false;
+  MacAddress secureon;
+  ProbeTarget probe = {0, 0, kProbeNone};
+  std::vector<String> depends_on;  // device names
+  int16_t priority = 0;            // higher wakes first
+  String group;
+  std::vector<String> tags;
+  WolDevice(){};
+  WolDevice(const String &m, const String &n) : mac(m), name(n) {}
+};
+
+bool operator<(const WolDevice &left, const WolDevice &right);
+bool operator==(const WolDevice &left, const WolDevice &right);
+
+struct ConfigLoadStats {
+  uint32_t parse_us;
+  uint32_t peak_heap;  // bytes, highest heap use above the start of the parse
+  uint32_t events;     // number of YAML events
+};
+
+class ConfigLoader {
+ public:
+  static const size_t kErrorSize = 64;
+
+  // Parses the YAML config in file into config and devices. On failure error
+  // holds a message for the display, it has to hold kErrorSize bytes.
+  static bool Load(fs::File &file, NetworkConfig &config,
+                   std::vector<WolDevice> &devices, char *error,
+                   ConfigLoadStats *stats = nullptr);
+  // Parses an IP address or a subnet in CIDR notation, which resolves to its
+  // directed broadcast address.
+  static bool ParseWolTarget(const String &target, uint32_t &ip);
+  // Parses "icmp", "arp" or "tcp:<port>".
+  static bool ParseProbe(const String &probe, ProbeTarget &target);
+};
+
+#endif /* SRC_CONFIGLOADER_H_ */
@@ -0,0 +1,94 @@
+/*
+ *
+ * DeviceFragment.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "DeviceFragment.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+static const char kRowStart[] = "<label class='toggle'>\n<span class='text'>";
+static const char kInputStart[] = "</span>\n<input type='checkbox' id='";
+static const char kInputName[] = "' name='";
+static const char kChecked[] = " checked";
+static const char kRowEnd[] =
+    " />\n<span class='value'></span>\n</label>\n<br>\n";
+
+// The constants without their '\0', 3 MACs, " (", ")" and "'"
+static const size_t kRowOverhead =
+    sizeof(kRowStart) + sizeof(kInputStart) + sizeof(kInputName) +
+    sizeof(kRowEnd) - 4 + 3 * (DeviceTable::kMacStringSize - 1) + 4;
+
+static_assert(kRowOverhead + sizeof(kChecked) - 1 +
+                      DeviceTable::kMaxNameLength <=
+                  DeviceFragment::kMaxRowLength,
+              "kMaxRowLength is too short for the longest name");
+
+void DeviceFragment::Build(const DeviceTable &devices) {
+  // Size the buffer up front, so it is allocated once
+  size_t total = devices.size() * kRowOverhead;
+  for (size_t i = 0; i < devices.size(); ++i) {
+    total += strlen(devices.Name(i));
+  }
+  html_.clear();
+  html_.reserve(total);
+  rows_.clear();
+  rows_.reserve(devices.size());
+
+  for (size_t i = 0; i < devices.size(); ++i) {
+    char mac[DeviceTable::kMacStringSize];
+    devices.FormatMac(i, mac);
+    Row row;
+    row.start = html_.size();
+    html_ += kRowStart;
+    html_ += devices.Name(i);
+    html_ += " (";
+    html_ += mac;
+    html_ += ")";
+    row.state = html_.size();
+    html_ += kInputStart;
+    html_ += mac;
+    html_ += kInputName;
+    html_ += mac;
+    html_ += "'";
+    row.checked = html_.size();
+    html_ += kRowEnd;
+    row.end = html_.size();
+    rows_.push_back(row);
+  }
+}
+
+size_t DeviceFragment::Render(size_t index, const char *state, bool checked,
+                              char *buf, size_t size) const {
+  const Row &row = rows_[index];
+  size_t n = 0;
+  auto append = [&](const char *text, size_t length) {
+    length = std::min(length, size - 1 - n);
+    memcpy(buf + n, text, length);
+    n += length;
+  };
+  append(html_.data() + row.start, row.state - row.start);
+  append(state, strlen(state));
+  append(html_.data() + row.state, row.checked - row.state);
+  if (checked) {
+    append(kChecked, sizeof(kChecked) - 1);
+  }
+  append(html_.data() + row.checked, row.end - row.checked);
+  buf[n] = '\0';
+  return n;
+}
+
+size_t DeviceFragment::MemoryUsage() const {
+  return html_.capacity() + rows_.capacity() * sizeof(Row);
+}
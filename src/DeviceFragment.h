@@ -0,0 +1,61 @@
+#ifndef SRC_DEVICEFRAGMENT_H_
+#define SRC_DEVICEFRAGMENT_H_
+
+/*
+ *
+ * DeviceFragment.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Checkbox list of the web interface, rendered once per device table into a
+single buffer. Each row keeps the offsets where the probe state and the
+checked attribute go, the only parts that change between requests, so
+rendering a row is a few copies.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "DeviceTable.h"
+
+class DeviceFragment {
+ public:
+  // Longest row without the state, for names of up to
+  // DeviceTable::kMaxNameLength
+  static const size_t kMaxRowLength = 264;
+
+  void Build(const DeviceTable &devices);
+  size_t size() const { return rows_.size(); }
+  // Writes the row of the device at index to buf, which holds size bytes,
+  // and returns its length. state is inserted after the device name. A row
+  // that doesn't fit is cut off, size has to exceed kMaxRowLength plus the
+  // length of state.
+  size_t Render(size_t index, const char *state, bool checked, char *buf,
+                size_t size) const;
+  size_t MemoryUsage() const;
+
+ private:
+  struct Row {
+    uint32_t start;
+    uint32_t state;    // where the probe state goes
+    uint32_t checked;  // where " checked" goes
+    uint32_t end;
+  };
+
+  std::string html_;
+  std::vector<Row> rows_;
+};
+
+#endif /* SRC_DEVICEFRAGMENT_H_ */
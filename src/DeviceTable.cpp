@@ -0,0 +1,187 @@
+/*
+ *
+ * DeviceTable.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "DeviceTable.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <numeric>
+
+void DeviceTable::Clear() {
+  macs_.clear();
+  names_.clear();
+  groups_.clear();
+  arena_.assign(1, '\0');  // offset 0 is the empty string
+  mac_index_.clear();
+  group_index_.clear();
+  tag_names_.clear();
+  tag_devices_.clear();
+  interned_.clear();
+}
+
+bool DeviceTable::Add(uint64_t mac, const char *name, const char *group,
+                      const std::vector<std::string> &tags) {
+  if (macs_.size() >= kMaxDevices) {
+    return false;
+  }
+  const uint16_t index = macs_.size();
+  macs_.push_back(mac);
+  names_.push_back(Intern(name));
+  groups_.push_back(Intern(group));
+  for (const std::string &tag : tags) {
+    tag_names_.push_back(Intern(tag.c_str()));
+    tag_devices_.push_back(index);
+  }
+  return true;
+}
+
+void DeviceTable::BuildIndexes() {
+  const char *arena = arena_.data();
+
+  mac_index_.resize(macs_.size());
+  std::iota(mac_index_.begin(), mac_index_.end(), 0);
+  std::sort(mac_index_.begin(), mac_index_.end(),
+            [this](uint16_t left, uint16_t right) {
+              return macs_[left] < macs_[right];
+            });
+
+  group_index_.clear();
+  for (size_t i = 0; i < groups_.size(); ++i) {
+    if (groups_[i] != 0) {
+      group_index_.push_back(i);
+    }
+  }
+  std::stable_sort(group_index_.begin(), group_index_.end(),
+                   [this, arena](uint16_t left, uint16_t right) {
+                     return strcmp(arena + groups_[left],
+                                   arena + groups_[right]) < 0;
+                   });
+
+  // Sort the tag entries by name, keeping the devices of a tag in order.
+  std::vector<uint32_t> order(tag_names_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [this, arena](uint32_t left, uint32_t right) {
+                     return strcmp(arena + tag_names_[left],
+                                   arena + tag_names_[right]) < 0;
+                   });
+  std::vector<uint32_t> tag_names(order.size());
+  std::vector<uint16_t> tag_devices(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    tag_names[i] = tag_names_[order[i]];
+    tag_devices[i] = tag_devices_[order[i]];
+  }
+  tag_names_.swap(tag_names);
+  tag_devices_.swap(tag_devices);
+
+  std::unordered_map<std::string, uint32_t>().swap(interned_);
+  macs_.shrink_to_fit();
+  names_.shrink_to_fit();
+  groups_.shrink_to_fit();
+  arena_.shrink_to_fit();
+}
+
+void DeviceTable::FormatMac(size_t index, char *buf) const {
+  static const char kHex[] = "0123456789abcdef";
+  const uint64_t mac = macs_[index];
+  for (int byte = 0; byte < 6; ++byte) {
+    const uint8_t value = mac >> (40 - 8 * byte);
+    buf[byte * 3] = kHex[value >> 4];
+    buf[byte * 3 + 1] = kHex[value & 0x0F];
+    buf[byte * 3 + 2] = byte < 5 ? ':' : '\0';
+  }
+}
+
+uint16_t DeviceTable::Find(uint64_t mac) const {
+  auto it = std::lower_bound(
+      mac_index_.begin(), mac_index_.end(), mac,
+      [this](uint16_t index, uint64_t value) { return macs_[index] < value; });
+  if (it == mac_index_.end() || macs_[*it] != mac) {
+    return kNotFound;
+  }
+  return *it;
+}
+
+uint16_t DeviceTable::FindDuplicate() const {
+  // The sort keeps no order among equal MACs, take the later device.
+  for (size_t i = 1; i < mac_index_.size(); ++i) {
+    const uint16_t left = mac_index_[i - 1];
+    const uint16_t right = mac_index_[i];
+    if (macs_[left] == macs_[right]) {
+      return std::max(left, right);
+    }
+  }
+  return kNotFound;
+}
+
+DeviceRange DeviceTable::FindGroup(const char *group) const {
+  const char *arena = arena_.data();
+  auto first = std::lower_bound(
+      group_index_.begin(), group_index_.end(), group,
+      [this, arena](uint16_t index, const char *value) {
+        return strcmp(arena + groups_[index], value) < 0;
+      });
+  auto last = std::upper_bound(
+      first, group_index_.end(), group,
+      [this, arena](const char *value, uint16_t index) {
+        return strcmp(value, arena + groups_[index]) < 0;
+      });
+  const uint16_t *devices = group_index_.data();
+  DeviceRange result = {devices + (first - group_index_.begin()),
+                        devices + (last - group_index_.begin())};
+  return result;
+}
+
+DeviceRange DeviceTable::FindTag(const char *tag) const {
+  const char *arena = arena_.data();
+  auto first = std::lower_bound(
+      tag_names_.begin(), tag_names_.end(), tag,
+      [arena](uint32_t name, const char *value) {
+        return strcmp(arena + name, value) < 0;
+      });
+  auto last = std::upper_bound(
+      first, tag_names_.end(), tag,
+      [arena](const char *value, uint32_t name) {
+        return strcmp(value, arena + name) < 0;
+      });
+  const uint16_t *devices = tag_devices_.data();
+  DeviceRange result = {devices + (first - tag_names_.begin()),
+                        devices + (last - tag_names_.begin())};
+  return result;
+}
+
+size_t DeviceTable::MemoryUsage() const {
+  return macs_.capacity() * sizeof(uint64_t) +
+         names_.capacity() * sizeof(uint32_t) +
+         groups_.capacity() * sizeof(uint32_t) + arena_.capacity() +
+         mac_index_.capacity() * sizeof(uint16_t) +
+         group_index_.capacity() * sizeof(uint16_t) +
+         tag_names_.capacity() * sizeof(uint32_t) +
+         tag_devices_.capacity() * sizeof(uint16_t);
+}
+
+uint32_t DeviceTable::Intern(const char *str) {
+  if (str == nullptr || *str == '\0') {
+    return 0;
+  }
+  auto it = interned_.find(str);
+  if (it != interned_.end()) {
+    return it->second;
+  }
+  const uint32_t offset = arena_.size();
+  arena_.insert(arena_.end(), str, str + strlen(str) + 1);
+  interned_.emplace(str, offset);
+  return offset;
+}
@@ -0,0 +1,90 @@
+#ifndef SRC_DEVICETABLE_H_
+#define SRC_DEVICETABLE_H_
+
+/*
+ *
+ * DeviceTable.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Packed store of the configured devices. MACs are kept as 48 bit integers,
+names, groups and tags are interned into one string arena, and sorted
+indexes allow MAC, group and tag lookups in O(log n).
+*/
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A run of device indices, as returned by the group and tag lookups
+struct DeviceRange {
+  const uint16_t *first;
+  const uint16_t *last;
+  const uint16_t *begin() const { return first; }
+  const uint16_t *end() const { return last; }
+  size_t size() const { return last - first; }
+};
+
+class DeviceTable {
+ public:
+  static const uint16_t kNotFound = 0xFFFF;
+  static const size_t kMaxDevices = kNotFound;
+  static const size_t kMacStringSize = 18;  // "00:11:22:33:44:55" + '\0'
+  // Longest name or group, the config loader rejects longer ones
+  static const size_t kMaxNameLength = 64;
+
+  DeviceTable() { Clear(); }
+  void Clear();
+  // Adds a device, BuildIndexes() has to be called once all are added.
+  // Returns false if the table is full.
+  bool Add(uint64_t mac, const char *name, const char *group,
+           const std::vector<std::string> &tags);
+  void BuildIndexes();
+  // Returns a device whose MAC an earlier one has already, or kNotFound.
+  // Find() can only return one of them, so the config is rejected.
+  uint16_t FindDuplicate() const;
+
+  size_t size() const { return macs_.size(); }
+  uint64_t Mac(size_t index) const { return macs_[index]; }
+  const char *Name(size_t index) const { return &arena_[names_[index]]; }
+  const char *Group(size_t index) const { return &arena_[groups_[index]]; }
+  // Writes the MAC of a device as lowercase colon separated hex, buf has to
+  // hold kMacStringSize bytes.
+  void FormatMac(size_t index, char *buf) const;
+
+  uint16_t Find(uint64_t mac) const;
+  DeviceRange FindGroup(const char *group) const;
+  DeviceRange FindTag(const char *tag) const;
+
+  // Bytes of heap held by the table
+  size_t MemoryUsage() const;
+
+ private:
+  uint32_t Intern(const char *str);
+
+  std::vector<uint64_t> macs_;
+  std::vector<uint32_t> names_;   // arena offsets
+  std::vector<uint32_t> groups_;  // arena offsets, 0 for no group
+  std::vector<char> arena_;
+
+  std::vector<uint16_t> mac_index_;    // device indices sorted by MAC
+  std::vector<uint16_t> group_index_;  // grouped devices sorted by group
+  std::vector<uint32_t> tag_names_;    // arena offsets sorted by tag
+  std::vector<uint16_t> tag_devices_;  // device of each tag_names_ entry
+
+  // Only needed while adding devices, freed by BuildIndexes()
+  std::unordered_map<std::string, uint32_t> interned_;
+};
+
+#endif  // SRC_DEVICETABLE_H_
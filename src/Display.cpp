@@ -14,64 +14,167 @@
 
 #include <Display.h>
 
+#include <algorithm>
+
 void I2CDisplay::Setup() {
   Wire.begin(I2C_SDA, I2C_SCL, I2C_SPEED);
   display_.setI2CAddress(SSD1315_ADDR);
   display_.begin();
   display_.setFont(u8g2_font_6x10_tr);
+  queue_ = xQueueCreate(DISPLAY_QUEUE_LENGTH, sizeof(Command));
+  if (queue_ == nullptr ||
+      xTaskCreatePinnedToCore(Task, "display", DISPLAY_STACK_SIZE, this,
+                              DISPLAY_PRIORITY, nullptr,
+                              DISPLAY_CORE) != pdPASS) {
+    Serial.println("Failed to start the display task.");
+  }
+}
+
+void I2CDisplay::StartRefresh(uint8_t interval) {
+  Command command;
+  command.type = Command::kStartRefresh;
+  command.interval = interval;
+  Post(command);
+}
+
+void I2CDisplay::UpdateMsgPage(const char *header, const char *msg) {
+  Command command;
+  command.type = Command::kMessage;
+  strlcpy(command.header, header, sizeof(command.header));
+  strlcpy(command.msg, msg, sizeof(command.msg));
+  Post(command);
+}
+
+void I2CDisplay::PreviousPage() {
+  Command command;
+  command.type = Command::kPrevious;
+  Post(command);
+}
+
+void I2CDisplay::NextPage() {
+  Command command;
+  command.type = Command::kNext;
+  Post(command);
+}
+
+void I2CDisplay::Post(const Command &command) {
+  if (queue_ != nullptr) {
+    xQueueSend(queue_, &command, 0);
+  }
+}
+
+void I2CDisplay::Task(void *display) {
+  static_cast<I2CDisplay *>(display)->Run();
+}
+
+// Runs the commands, and redraws the current page when the refresh is due
+void I2CDisplay::Run() {
+  TickType_t period = 0;  // no refresh before StartRefresh()
+  TickType_t next_refresh = 0;
+  Command command;
+  for (;;) {
+    TickType_t wait = portMAX_DELAY;
+    if (period != 0) {
+      const TickType_t now = xTaskGetTickCount();
+      wait = static_cast<int32_t>(next_refresh - now) > 0 ? next_refresh - now
+                                                          : 0;
+    }
+    if (xQueueReceive(queue_, &command, wait) != pdTRUE) {
+      DisplayCurrentPage();
+      next_refresh += period;
+      continue;
+    }
+    switch (command.type) {
+      case Command::kStartRefresh:
+        period = pdMS_TO_TICKS(command.interval * 1000);
+        next_refresh = xTaskGetTickCount();
+        break;
+      case Command::kPrevious:
+        DisplayPreviousPage();
+        break;
+      case Command::kNext:
+        DisplayNextPage();
+        break;
+      case Command::kMessage:
+        DrawMsgPage(command.header, command.msg);
+        break;
+    }
+  }
 }
 
 void I2CDisplay::DrawHeader() {
-  display_.drawStr(0, 8, ("IP: " + ETH.localIP().toString()).c_str());  // write something to the internal memory
+  SystemStatus status;
+  NetworkHandler::Status(status);
+  DrawHeader(status);
+}
+
+void I2CDisplay::DrawHeader(const SystemStatus &status) {
+  char line[32];
+  snprintf(line, sizeof(line), "IP: %s", status.ip);
+  Line(8, line);
   // display_.drawGlyph(118, 8, 0xe043);       // Network
-  if (!NetworkHandler::FirstWolSent()) {
-    display_.drawGlyph(122, 8, '1');  // NTP
+  if (status.pending_packets != 0) {
+    back_->marks[0] = '*';  // WOL packets queued
+  }
+  if (!status.first_wol_sent) {
+    back_->marks[1] = '1';  // NTP
   }
-  display_.drawBox(0, 10, 128 / 100.0F * (*timer_wol_ptr_).PercentRemaining(),
-                   4);  // progress bar
+  back_->bar = 128 / 100.0F * (*timer_wol_ptr_).PercentRemaining();
 }
 
-void I2CDisplay::UpdateMsgPage(const char *header, char *msg) {
-  char line_str[23];
-  display_.clearBuffer();
-  display_.drawStr(0, 8, header);
+void I2CDisplay::DrawMsgPage(const char *header, char *msg) {
+  BeginFrame();
+  Line(8, header);
   char *line_token;
   int i = 0;
   for (line_token = strtok(msg, "\n"); line_token && i < 6;
        line_token = strtok(NULL, "\n"), i++) {
-    display_.drawStr(0, 24 + i * 8, (const char *)line_token);
+    Line(24 + i * 8, (const char *)line_token);
   }
   current_page_ = status;
-  display_.sendBuffer();
+  EndFrame(Metrics::kPageMessage);
 }
 
 void I2CDisplay::UpdateStatusPage() {
-  display_.clearBuffer();
-  DrawHeader();
-  display_.drawStr(0, 24, ("Next WOL : " + NetworkHandler::GetNextWolTime(date_only)).c_str());
-  display_.drawStr(0, 32, ("           " + NetworkHandler::GetNextWolTime(time_only)).c_str());
-  display_.drawStr(0, 40, ("Cur. Time: " + NetworkHandler::GetTime(date_only)).c_str());
-  display_.drawStr(0, 48, ("           " + NetworkHandler::GetTime(time_only)).c_str());
-  display_.drawStr(0, 56, ("Boot Time: " + NetworkHandler::GetUptime(date_only)).c_str());
-  display_.drawStr(0, 64, ("           " + NetworkHandler::GetUptime(time_only)).c_str());
+  SystemStatus current;
+  NetworkHandler::Status(current);
+  BeginFrame();
+  DrawHeader(current);
+  char line[32];
+  snprintf(line, sizeof(line), "Next WOL : %s", current.next_wol_date);
+  Line(24, line);
+  snprintf(line, sizeof(line), "           %s", current.next_wol_time);
+  Line(32, line);
+  snprintf(line, sizeof(line), "Cur. Time: %s", current.date);
+  Line(40, line);
+  snprintf(line, sizeof(line), "           %s", current.time);
+  Line(48, line);
+  snprintf(line, sizeof(line), "Boot Time: %s", current.boot_date);
+  Line(56, line);
+  snprintf(line, sizeof(line), "           %s", current.boot_time);
+  Line(64, line);
   current_page_ = status;
-  display_.sendBuffer();
+  EndFrame(Metrics::kPageStatus);
 }
 
 void I2CDisplay::UpdateNetworkPage() {
-  display_.clearBuffer();
+  BeginFrame();
   DrawHeader();
-  display_.drawStr(0, 24, ("GW:   " + ETH.gatewayIP().toString()).c_str());
-  display_.drawStr(0, 32, ("NM:   " + ETH.subnetMask().toString()).c_str());
-  display_.drawStr(0, 40, ("DNS:  " + ETH.dnsIP().toString()).c_str());
-  display_.drawStr(0, 48, ("NTP1: " + NetworkHandler::Config().ntp1).c_str());
-  display_.drawStr(0, 56, ("NTP2: " + NetworkHandler::Config().ntp1).c_str());
-  display_.drawStr(0, 64, NetworkHandler::Config().timezone.c_str());
-  display_.sendBuffer();
+  Line(24, ("GW:   " + ETH.gatewayIP().toString()).c_str());
+  Line(32, ("NM:   " + ETH.subnetMask().toString()).c_str());
+  Line(40, ("DNS:  " + ETH.dnsIP().toString()).c_str());
+  {
+    SnapshotGuard snapshot = NetworkHandler::Snapshot();
+    Line(48, ("NTP1: " + snapshot->config.ntp1).c_str());
+    Line(56, ("NTP2: " + snapshot->config.ntp2).c_str());
+    Line(64, snapshot->config.timezone.c_str());
+  }
+  current_page_ = network;
+  EndFrame(Metrics::kPageNetwork);
 }
 
 void I2CDisplay::UpdateDevicePage() {
-  uint size = NetworkHandler::GetWolDevices().size(),
+  uint size = NetworkHandler::Snapshot()->devices.size(),
        start = 3 * current_device_page_,
        end = (start + 3) > size ? size : start + 3;
   DrawWolDevice(start, end);
@@ -79,7 +182,7 @@ void I2CDisplay::UpdateDevicePage() {
 
 bool I2CDisplay::PreviousWolDevicesPage() {
   bool had_previous = false;
-  uint size = NetworkHandler::GetWolDevices().size();
+  uint size = NetworkHandler::Snapshot()->devices.size();
   if (current_page_ != devices) {
     uint num_pages = std::ceil(size / 3.0F), start = (num_pages - 1) * 3,
          end = size < (num_pages * 3) ? size : num_pages * 3;
@@ -102,7 +205,7 @@ bool I2CDisplay::PreviousWolDevicesPage() {
 
 bool I2CDisplay::NextWolDevicesPage() {
   bool had_next = false;
-  uint size = NetworkHandler::GetWolDevices().size();
+  uint size = NetworkHandler::Snapshot()->devices.size();
   if (current_page_ != devices) {
     DrawWolDevice(0, size > 3 ? 3 : size);
     current_device_page_ = 0;
@@ -175,12 +278,113 @@ bool I2CDisplay::DisplayNextPage() {
 }
 
 void I2CDisplay::DrawWolDevice(const uint &start, const uint &end) {
-  display_.clearBuffer();
+  BeginFrame();
   DrawHeader();
-  for (uint i = start, pos = 0; i < end; i++, pos++) {
-    display_.drawStr(0, 24 + 16 * pos, (NetworkHandler::GetWolDevices()[i].name + ":").c_str());
-    display_.drawStr(0, 32 + 16 * pos, ("   " + NetworkHandler::GetWolDevices()[i].mac).c_str());
+  // The device list may have shrunk by a config reload since the page was
+  // picked.
+  SnapshotGuard snapshot = NetworkHandler::Snapshot();
+  const DeviceTable &table = snapshot->devices;
+  for (uint i = start, pos = 0; i < end && i < table.size(); i++, pos++) {
+    char state[16];
+    char mac[DeviceTable::kMacStringSize];
+    ProbeEngine::FormatState(i, state, sizeof(state));
+    table.FormatMac(i, mac);
+    char line[kLineSize];
+    snprintf(line, sizeof(line), "%s: %s", table.Name(i), state);
+    Line(24 + 16 * pos, line);
+    snprintf(line, sizeof(line), "   %s", mac);
+    Line(32 + 16 * pos, line);
   }
-  display_.sendBuffer();
   current_page_ = devices;
+  EndFrame(Metrics::kPageDevices);
+}
+
+void I2CDisplay::BeginFrame() { memset(back_, 0, sizeof(*back_)); }
+
+void I2CDisplay::Line(uint8_t y, const char *text) {
+  strlcpy(back_->lines[y / 8 - 1], text, kLineSize);
+}
+
+void I2CDisplay::EndFrame(Metrics::DisplayPage page) {
+  const int64_t start = esp_timer_get_time();
+  bool dirty[kLines];
+  for (uint8_t i = 0; i < kLines; ++i) {
+    dirty[i] =
+        !shown_valid_ || strcmp(back_->lines[i], front_->lines[i]) != 0;
+  }
+  dirty[0] = dirty[0] || memcmp(back_->marks, front_->marks, 2) != 0;
+  dirty[1] = dirty[1] || back_->bar != front_->bar;  // rows 10 to 13
+  std::swap(front_, back_);
+  if (!shown_valid_) {
+    display_.clearBuffer();
+  }
+  for (uint8_t i = 0; i < kLines; ++i) {
+    if (dirty[i]) {
+      RasterizeBand(i);
+    }
+  }
+  const uint32_t bytes = PushChangedTiles();
+  Metrics::display_bytes[page].Add(bytes);
+  Metrics::display_refresh[page].Observe(esp_timer_get_time() - start);
+}
+
+// Clears and redraws the rows a line can touch. Glyphs reach up to 8 rows
+// above the baseline and descenders 2 below, into the neighbouring lines,
+// so everything is drawn again, clipped to the band.
+void I2CDisplay::RasterizeBand(uint8_t line) {
+  const uint8_t top = line * 8;
+  const uint8_t bottom = std::min(top + 10, DISPLAY_HEIGHT);
+  display_.setClipWindow(0, top, DISPLAY_WIDTH, bottom);
+  display_.setDrawColor(0);
+  display_.drawBox(0, top, DISPLAY_WIDTH, bottom - top);
+  display_.setDrawColor(1);
+  DrawFrame();
+  display_.setMaxClipWindow();
+}
+
+void I2CDisplay::DrawFrame() {
+  for (uint8_t i = 0; i < kLines; ++i) {
+    if (front_->lines[i][0] != '\0') {
+      display_.drawStr(0, 8 * (i + 1), front_->lines[i]);
+    }
+  }
+  if (front_->marks[0] != '\0') {
+    display_.drawGlyph(116, 8, front_->marks[0]);
+  }
+  if (front_->marks[1] != '\0') {
+    display_.drawGlyph(122, 8, front_->marks[1]);
+  }
+  if (front_->bar > 0) {
+    display_.drawBox(0, 10, front_->bar, 4);  // progress bar
+  }
+}
+
+// Sends the runs of tiles that differ from the last sent buffer. The buffer
+// holds 8 rows of 128 bytes, a tile is 8 consecutive bytes of a row.
+uint32_t I2CDisplay::PushChangedTiles() {
+  const uint8_t *buffer = display_.getBufferPtr();
+  auto changed = [&](uint8_t tx, uint8_t ty) {
+    const size_t offset = ty * DISPLAY_WIDTH + tx * 8;
+    return !shown_valid_ || memcmp(buffer + offset, shown_ + offset, 8) != 0;
+  };
+  uint32_t bytes = 0;
+  for (uint8_t ty = 0; ty < kTileRows; ++ty) {
+    uint8_t tx = 0;
+    while (tx < kTileColumns) {
+      if (!changed(tx, ty)) {
+        tx++;
+        continue;
+      }
+      uint8_t end = tx + 1;
+      while (end < kTileColumns && changed(end, ty)) {
+        end++;
+      }
+      display_.updateDisplayArea(tx, ty, end - tx, 1);
+      bytes += (end - tx) * 8;
+      tx = end;
+    }
+  }
+  memcpy(shown_, buffer, sizeof(shown_));
+  shown_valid_ = true;
+  return bytes;
 }
\ No newline at end of file
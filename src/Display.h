@@ -18,11 +18,21 @@
 /*
 Class for 128x64 OLED I2C display with 4 buttons from
 https://www.aliexpress.com/item/1005006322621064.html?spm=a2g0o.order_list.order_list_main.58.5bbf1802eNcJxk
+
+Pages are drawn as a frame of text lines, which is compared with the frame
+on screen. Only the bands of changed lines are cleared and rasterized again,
+then the 8x8 pixel tiles that differ from those last sent are pushed with
+updateDisplayArea(), instead of the whole 1 KiB buffer.
+
+All drawing and I2C transfers happen in a task of their own on core 0, so
+the Arduino loop on core 1 neither waits for the display nor shares its
+core with it. The task runs below the network tasks of core 0. Other tasks
+only queue commands for it. The task draws a page into the back frame,
+swaps it to the front and then pushes what changed.
 */
 
 #include <vector>
 
-#include <Button.h>
 #include <U8g2lib.h>
 #include <Wire.h>
 
@@ -33,10 +43,13 @@ https://www.aliexpress.com/item/1005006322621064.html?spm=a2g0o.order_list.order
 #define I2C_SCL 32
 #define SSD1315_ADDR 0x78
 #define I2C_SPEED 400E3
-#define BUTTON_UP 36
-#define BUTTON_DOWN 39
-#define BUTTON_HASH 34
-#define BUTTON_STAR 35
+#define DISPLAY_WIDTH 128
+#define DISPLAY_HEIGHT 64
+#define DISPLAY_QUEUE_LENGTH 4
+#define DISPLAY_MESSAGE_SIZE 128
+#define DISPLAY_STACK_SIZE 4096
+#define DISPLAY_PRIORITY 1
+#define DISPLAY_CORE 0  // the Arduino loop runs on core 1
 
 // Macro to invoke member function from pointer
 #define CALL_MEMBER_FN(object,ptrToMember)  ((object).*(ptrToMember))
@@ -44,22 +57,50 @@ https://www.aliexpress.com/item/1005006322621064.html?spm=a2g0o.order_list.order
 class I2CDisplay {
  public:
   I2CDisplay(Timer *const t)
-      : button_up_(BUTTON_UP),
-        button_down_(BUTTON_DOWN),
-        button_hash_(BUTTON_HASH),
-        button_star_(BUTTON_STAR),
-        timer_wol_ptr_(t),
+      : timer_wol_ptr_(t),
         display_(U8G2_R0),
         current_page_(status),
-        current_device_page_(0) {
-    button_up_.begin();
-    button_down_.begin();
-    button_hash_.begin();
-    button_star_.begin();
-  }
+        current_device_page_(0),
+        queue_(nullptr),
+        frames_(),
+        front_(&frames_[0]),
+        back_(&frames_[1]),
+        shown_valid_(false) {}
+  // Starts the display task. The calls below only queue a command for it,
+  // they never block and are dropped while the queue is full.
   void Setup();
+  // Redraws the current page every interval seconds from now on
+  void StartRefresh(uint8_t interval);
+  void UpdateMsgPage(const char *header, const char *msg);
+  void PreviousPage();
+  void NextPage();
+
+ private:
+  static const uint8_t kLines = DISPLAY_HEIGHT / 8;  // baselines 8 to 64
+  static const uint8_t kLineSize = DISPLAY_WIDTH / 6 + 1;  // 6x10 font, '\0'
+  static const uint8_t kTileColumns = DISPLAY_WIDTH / 8;
+  static const uint8_t kTileRows = DISPLAY_HEIGHT / 8;
+
+  // Contents of a page, the header glyphs and progress bar included
+  struct Frame {
+    char lines[kLines][kLineSize];
+    char marks[2];  // header glyphs at x 116 and 122, '\0' for none
+    uint8_t bar;    // width of the progress bar
+  };
+
+  struct Command {
+    enum Type : uint8_t { kStartRefresh, kPrevious, kNext, kMessage } type;
+    uint8_t interval;  // s, of kStartRefresh
+    char header[kLineSize];
+    char msg[DISPLAY_MESSAGE_SIZE];
+  };
+
+  static void Task(void *display);
+  void Run();
+  void Post(const Command &command);
   void DrawHeader();
-  void UpdateMsgPage(const char* header, char *msg);
+  void DrawHeader(const SystemStatus &status);
+  void DrawMsgPage(const char *header, char *msg);
   void UpdateStatusPage();
   void UpdateNetworkPage();
   void UpdateDevicePage();
@@ -68,18 +109,16 @@ class I2CDisplay {
   void DisplayCurrentPage();
   bool DisplayPreviousPage();
   bool DisplayNextPage();
-  bool ButtonUpPressed() { return button_up_.pressed(); }
-  bool ButtonDownPressed() { return button_down_.pressed(); }
-  bool ButtonHashPressed() { return button_hash_.pressed(); }
-  bool ButtonStarPressed() { return button_star_.pressed(); }
 
- private:
   void DrawWolDevice(const uint &start, const uint &end);
+  void BeginFrame();
+  // Sets the line with the baseline y, text longer than the display is cut.
+  void Line(uint8_t y, const char *text);
+  void EndFrame(Metrics::DisplayPage page);
+  void RasterizeBand(uint8_t line);
+  void DrawFrame();
+  uint32_t PushChangedTiles();
 
-  Button button_up_;
-  Button button_down_;
-  Button button_hash_;
-  Button button_star_;
   Timer *const timer_wol_ptr_;
   U8G2_SSD1306_128X64_NONAME_F_HW_I2C display_;
   enum Pages{
@@ -89,6 +128,12 @@ class I2CDisplay {
   };
   Pages current_page_;
   uint current_device_page_;
+  QueueHandle_t queue_;
+  Frame frames_[2];
+  Frame *front_;  // on screen
+  Frame *back_;   // being drawn by a page
+  bool shown_valid_;
+  uint8_t shown_[DISPLAY_WIDTH * DISPLAY_HEIGHT / 8];  // last buffer sent
 };
 
 // I2CDisplay class Member function pointer type
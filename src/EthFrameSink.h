@@ -0,0 +1,38 @@
+#ifndef SRC_ETHFRAMESINK_H_
+#define SRC_ETHFRAMESINK_H_
+
+/*
+ *
+ * EthFrameSink.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <FrameSink.h>
+
+#include "NetworkHandler.h"
+
+// Sends raw frames straight to the Ethernet driver, skipping lwIP
+class EthFrameSink : public FrameSink {
+ public:
+  // The stock ETHClass of Arduino core 3 has no raw transmit
+  static const bool kAvailable =
+      ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3, 0, 0);
+
+  bool sendFrame(const uint8_t *frame, size_t length) override {
+#if ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3, 0, 0)
+    return ETH.transmit(frame, length);
+#else
+    return false;
+#endif
+  }
+};
+
+#endif  // SRC_ETHFRAMESINK_H_
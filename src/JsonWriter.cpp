@@ -0,0 +1,106 @@
+/*
+ *
+ * JsonWriter.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "JsonWriter.h"
+
+void JsonWriter::Key(const char *key) {
+  Separate();
+  Quoted(key);
+  out_.print(':');
+  after_key_ = true;
+}
+
+void JsonWriter::Str(const char *value) {
+  Separate();
+  Quoted(value);
+}
+
+void JsonWriter::Int(int32_t value) {
+  Separate();
+  out_.print(static_cast<long>(value));
+}
+
+void JsonWriter::UInt(uint32_t value) {
+  Separate();
+  out_.print(static_cast<unsigned long>(value));
+}
+
+void JsonWriter::Bool(bool value) {
+  Separate();
+  out_.print(value ? "true" : "false");
+}
+
+void JsonWriter::Null() {
+  Separate();
+  out_.print("null");
+}
+
+void JsonWriter::Open(char bracket) {
+  Separate();
+  out_.print(bracket);
+  if (depth_ < kMaxDepth) {
+    depth_++;
+    has_values_ &= ~(1UL << (depth_ - 1));
+  }
+}
+
+void JsonWriter::Close(char bracket) {
+  out_.print(bracket);
+  if (depth_ > 0) {
+    depth_--;
+  }
+}
+
+// Prints the comma in front of every value but the first of its level. A
+// value following a key belongs to the key.
+void JsonWriter::Separate() {
+  if (after_key_) {
+    after_key_ = false;
+    return;
+  }
+  if (depth_ == 0) {
+    return;
+  }
+  const uint32_t bit = 1UL << (depth_ - 1);
+  if (has_values_ & bit) {
+    out_.print(',');
+  }
+  has_values_ |= bit;
+}
+
+void JsonWriter::Quoted(const char *str) {
+  static const char kHex[] = "0123456789abcdef";
+  out_.print('"');
+  const char *run = str;  // unescaped characters are printed in runs
+  for (const char *c = str;; ++c) {
+    const uint8_t ch = *c;
+    if (ch != 0 && ch != '"' && ch != '\\' && ch >= 0x20) {
+      continue;
+    }
+    out_.write(reinterpret_cast<const uint8_t *>(run), c - run);
+    if (ch == 0) {
+      break;
+    }
+    if (ch == '"' || ch == '\\') {
+      const char escaped[] = {'\\', static_cast<char>(ch)};
+      out_.write(reinterpret_cast<const uint8_t *>(escaped), 2);
+    } else {
+      const char escaped[] = {'\\', 'u', '0', '0', kHex[ch >> 4],
+                              kHex[ch & 0xF]};
+      out_.write(reinterpret_cast<const uint8_t *>(escaped), 6);
+    }
+    run = c + 1;
+  }
+  out_.print('"');
+}
@@ -0,0 +1,90 @@
+#ifndef SRC_JSONWRITER_H_
+#define SRC_JSONWRITER_H_
+
+/*
+ *
+ * JsonWriter.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Minimal streaming JSON writer. Values are printed to the output as they
+are added, nothing is buffered besides one bit per nesting level, which
+tracks whether a separator is due. The caller is responsible for a well
+formed sequence of calls, nesting is limited to kMaxDepth levels.
+*/
+
+#include <Arduino.h>
+
+class JsonWriter {
+ public:
+  static const uint8_t kMaxDepth = 32;
+
+  explicit JsonWriter(Print &out) : out_(out) {}
+
+  void BeginObject() { Open('{'); }
+  void EndObject() { Close('}'); }
+  void BeginArray() { Open('['); }
+  void EndArray() { Close(']'); }
+  void Key(const char *key);
+
+  void Str(const char *value);
+  void Int(int32_t value);
+  void UInt(uint32_t value);
+  void Bool(bool value);
+  void Null();
+
+ private:
+  void Open(char bracket);
+  void Close(char bracket);
+  void Separate();
+  void Quoted(const char *str);
+
+  Print &out_;
+  uint8_t depth_ = 0;
+  uint32_t has_values_ = 0;  // bit n is set once level n got a value
+  bool after_key_ = false;
+};
+
+// Prints into a fixed buffer and keeps it terminated. Output that doesn't
+// fit is dropped.
+class BufferPrint : public Print {
+ public:
+  BufferPrint(char *buffer, size_t size) { Reset(buffer, size); }
+  // Reset() has to be called before printing
+  BufferPrint() : buffer_(nullptr), size_(0), length_(0) {}
+
+  // Starts over in another buffer
+  void Reset(char *buffer, size_t size) {
+    buffer_ = buffer;
+    size_ = size;
+    length_ = 0;
+    buffer_[0] = '\0';
+  }
+  size_t length() const { return length_; }
+  size_t remaining() const { return size_ - 1 - length_; }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *data, size_t size) override {
+    size_t n = size < remaining() ? size : remaining();
+    memcpy(buffer_ + length_, data, n);
+    length_ += n;
+    buffer_[length_] = '\0';
+    return n;
+  }
+
+ private:
+  char *buffer_;
+  size_t size_;
+  size_t length_;
+};
+
+#endif /* SRC_JSONWRITER_H_ */
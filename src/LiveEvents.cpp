@@ -0,0 +1,184 @@
+/*
+ *
+ * LiveEvents.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "LiveEvents.h"
+
+#include "DeviceTable.h"
+#include "JsonWriter.h"
+
+// Longest entry of a "sent" or "online" batch, with separator
+static const size_t kMaxEntrySize = 64;
+
+AsyncEventSource LiveEvents::source_("/events");
+QueueHandle_t LiveEvents::queue_ = nullptr;
+LiveEvents::StatusFn LiveEvents::status_ = nullptr;
+LiveEvents::MacFn LiveEvents::mac_ = nullptr;
+LiveStatus LiveEvents::last_;
+int64_t LiveEvents::next_tick_ = 0;
+std::atomic<bool> LiveEvents::full_status_due_(true);
+std::atomic<uint32_t> LiveEvents::dropped_events_(0);
+char LiveEvents::buffer_[LIVE_EVENTS_BUFFER_SIZE];
+
+bool LiveEvents::Setup(AsyncWebServer &server,
+                       ArRequestFilterFunction authenticate, StatusFn status,
+                       MacFn mac) {
+  queue_ = xQueueCreate(LIVE_EVENTS_QUEUE_SIZE, sizeof(Event));
+  if (queue_ == nullptr) {
+    return false;
+  }
+  status_ = status;
+  mac_ = mac;
+  source_.setFilter(authenticate);
+  // A new client needs the full status, the next tick sends it to everyone.
+  source_.onConnect(
+      [](AsyncEventSourceClient *client) { full_status_due_ = true; });
+  server.addHandler(&source_);
+  return true;
+}
+
+void LiveEvents::PacketSent(uint16_t index) {
+  Queue({kPacketSent, index, 0});
+}
+
+void LiveEvents::DeviceOnline(size_t index, uint32_t seconds) {
+  Queue({kDeviceOnline, static_cast<uint16_t>(index), seconds});
+}
+
+void LiveEvents::Queue(const Event &event) {
+  if (queue_ != nullptr && xQueueSend(queue_, &event, 0) != pdTRUE) {
+    dropped_events_++;
+  }
+}
+
+void LiveEvents::Tick() {
+  const int64_t now = esp_timer_get_time();
+  if (queue_ == nullptr || now < next_tick_) {
+    return;
+  }
+  next_tick_ = now + 1000000;
+  if (source_.count() == 0) {
+    xQueueReset(queue_);  // nobody to tell
+    full_status_due_ = true;
+    return;
+  }
+
+  LiveStatus status;
+  status_(status);
+  status.dropped_events = dropped_events_;
+  const bool full = full_status_due_.exchange(false);
+  BufferPrint out(buffer_, sizeof(buffer_));
+  if (WriteStatus(full ? nullptr : &last_, status, out)) {
+    source_.send(buffer_, "status");
+  }
+  last_ = status;
+  SendQueued();
+}
+
+bool LiveEvents::WriteStatus(const LiveStatus *previous,
+                             const LiveStatus &current, Print &out) {
+  JsonWriter json(out);
+  bool changed = false;
+  auto key = [&](bool differs, const char *name) {
+    if (previous != nullptr && !differs) {
+      return false;
+    }
+    if (!changed) {
+      json.BeginObject();
+      changed = true;
+    }
+    json.Key(name);
+    return true;
+  };
+  if (key(previous && strcmp(previous->next_wol, current.next_wol),
+          "next_wol")) {
+    json.Str(current.next_wol);
+  }
+  if (key(previous && previous->link != current.link, "link")) {
+    json.Bool(current.link);
+  }
+  if (key(previous && previous->ntp != current.ntp, "ntp")) {
+    json.Bool(current.ntp);
+  }
+  if (key(previous && previous->first_wol_sent != current.first_wol_sent,
+          "first_wol_sent")) {
+    json.Bool(current.first_wol_sent);
+  }
+  if (key(previous && previous->pending_packets != current.pending_packets,
+          "pending_packets")) {
+    json.UInt(current.pending_packets);
+  }
+  if (key(previous &&
+              previous->last_completed_job != current.last_completed_job,
+          "last_completed_job")) {
+    json.UInt(current.last_completed_job);
+  }
+  if (key(previous && previous->config_version != current.config_version,
+          "config_version")) {
+    json.UInt(current.config_version);
+  }
+  if (key(previous && previous->coalesced_wakes != current.coalesced_wakes,
+          "coalesced_wakes")) {
+    json.UInt(current.coalesced_wakes);
+  }
+  if (key(previous && previous->limited_requests != current.limited_requests,
+          "limited_requests")) {
+    json.UInt(current.limited_requests);
+  }
+  if (key(previous && previous->dropped_events != current.dropped_events,
+          "dropped_events")) {
+    json.UInt(current.dropped_events);
+  }
+  if (changed) {
+    json.EndObject();
+  }
+  return changed;
+}
+
+// Sends the queued events as JSON arrays, one event per run of the same type
+// that fits the buffer. A run of events of removed devices only sends nothing.
+void LiveEvents::SendQueued() {
+  Event event;
+  while (xQueuePeek(queue_, &event, 0) == pdTRUE) {
+    const EventType type = event.type;
+    BufferPrint out(buffer_, sizeof(buffer_));
+    JsonWriter json(out);
+    json.BeginArray();
+    size_t entries = 0;
+    while (out.remaining() > kMaxEntrySize &&
+           xQueuePeek(queue_, &event, 0) == pdTRUE && event.type == type) {
+      xQueueReceive(queue_, &event, 0);
+      char mac[DeviceTable::kMacStringSize];
+      mac_(event.index, mac);
+      if (mac[0] == '\0') {
+        continue;  // removed by a config reload
+      }
+      if (type == kPacketSent) {
+        json.Str(mac);
+      } else {
+        json.BeginObject();
+        json.Key("mac");
+        json.Str(mac);
+        json.Key("seconds");
+        json.UInt(event.seconds);
+        json.EndObject();
+      }
+      entries++;
+    }
+    if (entries == 0) {
+      continue;
+    }
+    json.EndArray();
+    source_.send(buffer_, type == kPacketSent ? "sent" : "online");
+  }
+}
@@ -0,0 +1,91 @@
+#ifndef SRC_LIVEEVENTS_H_
+#define SRC_LIVEEVENTS_H_
+
+/*
+ *
+ * LiveEvents.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Server-Sent Events channel of the web interface at /events. Once per
+second the status is compared with the one sent last and only the changed
+fields are pushed, as a "status" event. Packets sent and devices coming
+online are queued by the tasks that see them and pushed in batches, as
+"sent" and "online" events. Every event is serialized once into a shared
+buffer, which the event source sends to all clients.
+*/
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+#include <atomic>
+
+#define LIVE_EVENTS_QUEUE_SIZE 64
+#define LIVE_EVENTS_BUFFER_SIZE 512
+
+struct LiveStatus {
+  char next_wol[32];
+  bool link;
+  bool ntp;
+  bool first_wol_sent;
+  uint32_t pending_packets;
+  uint32_t last_completed_job;
+  uint32_t config_version;
+  uint32_t coalesced_wakes;
+  uint32_t limited_requests;
+  uint32_t dropped_events;  // filled in by LiveEvents
+};
+
+class LiveEvents {
+ public:
+  typedef void (*StatusFn)(LiveStatus &status);
+  // Writes the MAC of the device at index, or "" if there is no such device
+  typedef void (*MacFn)(uint16_t index, char *buf);
+
+  // Only clients for which authenticate returns true are accepted.
+  static bool Setup(AsyncWebServer &server,
+                    ArRequestFilterFunction authenticate, StatusFn status,
+                    MacFn mac);
+  // Called from the wake engine and probe tasks, never block.
+  static void PacketSent(uint16_t index);
+  static void DeviceOnline(size_t index, uint32_t seconds);
+  // Called from the Arduino loop, pushes at most once per second.
+  static void Tick();
+
+  // Writes the fields of current that differ from previous as a JSON object,
+  // all of them if previous is nullptr. Returns false if none differ.
+  static bool WriteStatus(const LiveStatus *previous,
+                          const LiveStatus &current, Print &out);
+
+ private:
+  enum EventType : uint8_t { kPacketSent, kDeviceOnline };
+  struct Event {
+    EventType type;
+    uint16_t index;
+    uint32_t seconds;
+  };
+
+  static void Queue(const Event &event);
+  static void SendQueued();
+
+  static AsyncEventSource source_;
+  static QueueHandle_t queue_;
+  static StatusFn status_;
+  static MacFn mac_;
+  static LiveStatus last_;
+  static int64_t next_tick_;
+  static std::atomic<bool> full_status_due_;
+  static std::atomic<uint32_t> dropped_events_;
+  static char buffer_[LIVE_EVENTS_BUFFER_SIZE];
+};
+
+#endif /* SRC_LIVEEVENTS_H_ */
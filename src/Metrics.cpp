@@ -0,0 +1,267 @@
+/*
+ *
+ * Metrics.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "Metrics.h"
+
+#include <memory>
+
+enum MetricsPlaceholder : uint8_t {
+  kPacketsSentPlaceholder,
+  kSendFailuresPlaceholder,
+  kWakesCoalescedPlaceholder,
+  kRequestsLimitedPlaceholder,
+  kLoopLatencyPlaceholder,
+  kHttpLatencyPlaceholder,
+  kHeapFreePlaceholder,
+  kHeapMinFreePlaceholder,
+  kHeapLargestBlockPlaceholder,
+  kLinkDownsPlaceholder,
+  kNtpSyncAgePlaceholder,
+  kDisplayBytesPlaceholder,
+  kDisplayRefreshPlaceholder,
+};
+static const char *const kPlaceholders[] = {
+    "PACKETS_SENT",       "SEND_FAILURES", "WAKES_COALESCED",
+    "REQUESTS_LIMITED",   "LOOP_LATENCY",  "HTTP_LATENCY",
+    "HEAP_FREE",          "HEAP_MIN_FREE", "HEAP_LARGEST_BLOCK",
+    "LINK_DOWNS",         "NTP_SYNC_AGE",  "DISPLAY_BYTES",
+    "DISPLAY_REFRESH"};
+
+static const char kPage[] =
+    "# HELP wol_packets_sent_total WOL packets sent per device.\n"
+    "# TYPE wol_packets_sent_total counter\n"
+    "%PACKETS_SENT%"
+    "# HELP wol_send_failures_total WOL packets the network stack refused.\n"
+    "# TYPE wol_send_failures_total counter\n"
+    "%SEND_FAILURES%"
+    "# HELP wol_wakes_coalesced_total Wakes joined to a recent one.\n"
+    "# TYPE wol_wakes_coalesced_total counter\n"
+    "%WAKES_COALESCED%"
+    "# HELP wol_requests_limited_total Requests refused by the client limit.\n"
+    "# TYPE wol_requests_limited_total counter\n"
+    "%REQUESTS_LIMITED%"
+    "# HELP wol_loop_duration_seconds Duration of one run of the main loop.\n"
+    "# TYPE wol_loop_duration_seconds histogram\n"
+    "%LOOP_LATENCY%"
+    "# HELP wol_http_request_duration_seconds Time spent in request handlers.\n"
+    "# TYPE wol_http_request_duration_seconds histogram\n"
+    "%HTTP_LATENCY%"
+    "# HELP wol_heap_free_bytes Free heap.\n"
+    "# TYPE wol_heap_free_bytes gauge\n"
+    "%HEAP_FREE%"
+    "# HELP wol_heap_min_free_bytes Lowest free heap since boot.\n"
+    "# TYPE wol_heap_min_free_bytes gauge\n"
+    "%HEAP_MIN_FREE%"
+    "# HELP wol_heap_largest_free_block_bytes Largest allocatable block.\n"
+    "# TYPE wol_heap_largest_free_block_bytes gauge\n"
+    "%HEAP_LARGEST_BLOCK%"
+    "# HELP wol_eth_link_down_total Times the Ethernet link went down.\n"
+    "# TYPE wol_eth_link_down_total counter\n"
+    "%LINK_DOWNS%"
+    "# HELP wol_ntp_sync_age_seconds Time since the last NTP sync.\n"
+    "# TYPE wol_ntp_sync_age_seconds gauge\n"
+    "%NTP_SYNC_AGE%"
+    "# HELP wol_display_i2c_bytes_total Display data sent over I2C.\n"
+    "# TYPE wol_display_i2c_bytes_total counter\n"
+    "%DISPLAY_BYTES%"
+    "# HELP wol_display_refresh_seconds Time to update the display.\n"
+    "# TYPE wol_display_refresh_seconds histogram\n"
+    "%DISPLAY_REFRESH%";
+
+static const char *const kRouteNames[Metrics::kRouteCount] = {
+    "index",       "wake",       "config",   "login",   "asset",
+    "api_devices", "api_status", "api_wake", "metrics", "not_found"};
+
+static const char *const kPageNames[Metrics::kPageCount] = {
+    "status", "devices", "network", "message"};
+
+const uint32_t Histogram::kBounds[kBuckets - 1] = {
+    50,    100,   250,    500,    1000,   2500,   5000,
+    10000, 25000, 50000, 100000, 250000, 500000, 1000000};
+// kBounds in seconds, as the le labels of the buckets
+static const char *const kBoundLabels[Histogram::kBuckets] = {
+    "5e-05", "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01",
+    "0.025", "0.05",   "0.1",     "0.25",   "0.5",   "1",      "+Inf"};
+
+Counter Metrics::udp_failures;
+Counter Metrics::frame_failures;
+Counter Metrics::link_downs;
+Counter Metrics::wakes_coalesced;
+Counter Metrics::requests_limited;
+Histogram Metrics::loop_latency;
+Histogram Metrics::http_latency[kRouteCount];
+Counter Metrics::display_bytes[kPageCount];
+Histogram Metrics::display_refresh[kPageCount];
+PageTemplate Metrics::page_;
+Metrics::DeviceFn Metrics::devices_ = nullptr;
+std::atomic<uint32_t> Metrics::ntp_synced_(0);
+
+void Histogram::Observe(uint32_t micros) {
+  uint8_t bucket = 0;
+  while (bucket < kBuckets - 1 && micros > kBounds[bucket]) {
+    bucket++;
+  }
+  counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(micros, std::memory_order_relaxed);
+}
+
+size_t Histogram::Format(size_t line, const char *name, const char *labels,
+                         char *buf, size_t size) const {
+  const char *separator = labels[0] == '\0' ? "" : ",";
+  if (line < kBuckets) {
+    uint32_t count = 0;
+    for (size_t i = 0; i <= line; ++i) {
+      count += counts_[i].load(std::memory_order_relaxed);
+    }
+    return snprintf(buf, size, "%s_bucket{%s%sle=\"%s\"} %u\n", name, labels,
+                    separator, kBoundLabels[line],
+                    static_cast<unsigned>(count));
+  }
+  const char *open = labels[0] == '\0' ? "" : "{";
+  const char *close = labels[0] == '\0' ? "" : "}";
+  if (line == kBuckets) {
+    const uint64_t sum = sum_.load(std::memory_order_relaxed);
+    return snprintf(buf, size, "%s_sum%s%s%s %u.%06u\n", name, open, labels,
+                    close, static_cast<unsigned>(sum / 1000000),
+                    static_cast<unsigned>(sum % 1000000));
+  }
+  if (line == kBuckets + 1) {
+    uint32_t count = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      count += counts_[i].load(std::memory_order_relaxed);
+    }
+    return snprintf(buf, size, "%s_count%s%s%s %u\n", name, open, labels,
+                    close, static_cast<unsigned>(count));
+  }
+  return PageRenderer::kNoItem;
+}
+
+void Metrics::Setup(DeviceFn devices) {
+  devices_ = devices;
+  page_.Parse(kPage, sizeof(kPage) - 1, kPlaceholders,
+              sizeof(kPlaceholders) / sizeof(kPlaceholders[0]));
+}
+
+void Metrics::Send(AsyncWebServerRequest *request) {
+  std::shared_ptr<PageRenderer> renderer =
+      std::make_shared<PageRenderer>(page_, Fill);
+  request->send(request->beginChunkedResponse(
+      METRICS_CONTENT_TYPE,
+      [renderer](uint8_t *buffer, size_t max_len, size_t index) {
+        return renderer->Read(buffer, max_len);
+      }));
+}
+
+size_t Metrics::Fill(uint8_t placeholder, size_t item, char *buf,
+                     size_t size) {
+  switch (placeholder) {
+    case kPacketsSentPlaceholder:
+      return devices_(item, buf, size);
+    case kSendFailuresPlaceholder:
+      if (item > 1) {
+        return PageRenderer::kNoItem;
+      }
+      return snprintf(
+          buf, size, "wol_send_failures_total{transport=\"%s\"} %u\n",
+          item == 0 ? "udp" : "ethernet",
+          static_cast<unsigned>(item == 0 ? udp_failures.value()
+                                          : frame_failures.value()));
+    case kLoopLatencyPlaceholder:
+      return loop_latency.Format(item, "wol_loop_duration_seconds", "", buf,
+                                 size);
+    case kHttpLatencyPlaceholder: {
+      const size_t route = item / Histogram::kLines;
+      if (route >= kRouteCount) {
+        return PageRenderer::kNoItem;
+      }
+      char labels[32];
+      snprintf(labels, sizeof(labels), "route=\"%s\"", kRouteNames[route]);
+      return http_latency[route].Format(item % Histogram::kLines,
+                                        "wol_http_request_duration_seconds",
+                                        labels, buf, size);
+    }
+    case kDisplayBytesPlaceholder:
+      if (item >= kPageCount) {
+        return PageRenderer::kNoItem;
+      }
+      return snprintf(buf, size,
+                      "wol_display_i2c_bytes_total{page=\"%s\"} %u\n",
+                      kPageNames[item],
+                      static_cast<unsigned>(display_bytes[item].value()));
+    case kDisplayRefreshPlaceholder: {
+      const size_t page = item / Histogram::kLines;
+      if (page >= kPageCount) {
+        return PageRenderer::kNoItem;
+      }
+      char labels[32];
+      snprintf(labels, sizeof(labels), "page=\"%s\"", kPageNames[page]);
+      return display_refresh[page].Format(item % Histogram::kLines,
+                                          "wol_display_refresh_seconds",
+                                          labels, buf, size);
+    }
+    default:
+      break;
+  }
+  if (item > 0) {
+    return PageRenderer::kNoItem;
+  }
+  switch (placeholder) {
+    case kHeapFreePlaceholder:
+      return snprintf(buf, size, "wol_heap_free_bytes %u\n",
+                      static_cast<unsigned>(ESP.getFreeHeap()));
+    case kHeapMinFreePlaceholder:
+      return snprintf(buf, size, "wol_heap_min_free_bytes %u\n",
+                      static_cast<unsigned>(ESP.getMinFreeHeap()));
+    case kHeapLargestBlockPlaceholder:
+      return snprintf(buf, size, "wol_heap_largest_free_block_bytes %u\n",
+                      static_cast<unsigned>(ESP.getMaxAllocHeap()));
+    case kWakesCoalescedPlaceholder:
+      return snprintf(buf, size, "wol_wakes_coalesced_total %u\n",
+                      static_cast<unsigned>(wakes_coalesced.value()));
+    case kRequestsLimitedPlaceholder:
+      return snprintf(buf, size, "wol_requests_limited_total %u\n",
+                      static_cast<unsigned>(requests_limited.value()));
+    case kLinkDownsPlaceholder:
+      return snprintf(buf, size, "wol_eth_link_down_total %u\n",
+                      static_cast<unsigned>(link_downs.value()));
+    case kNtpSyncAgePlaceholder: {
+      const uint32_t synced = ntp_synced_;
+      if (synced == 0) {
+        return PageRenderer::kNoItem;  // no sample until the first sync
+      }
+      return snprintf(
+          buf, size, "wol_ntp_sync_age_seconds %u\n",
+          static_cast<unsigned>(esp_timer_get_time() / 1000000 + 1 - synced));
+    }
+    default:
+      return PageRenderer::kNoItem;
+  }
+}
+
+size_t Metrics::EscapeLabel(const char *value, char *buf, size_t size) {
+  size_t length = 0;
+  for (; *value != '\0' && length + 3 <= size; ++value) {
+    if (*value == '\\' || *value == '"') {
+      buf[length++] = '\\';
+      buf[length++] = *value;
+    } else if (*value == '\n') {
+      buf[length++] = '\\';
+      buf[length++] = 'n';
+    } else {
+      buf[length++] = *value;
+    }
+  }
+  buf[length] = '\0';
+  return length;
+}
@@ -0,0 +1,136 @@
+#ifndef SRC_METRICS_H_
+#define SRC_METRICS_H_
+
+/*
+ *
+ * Metrics.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Registry of counters and latency histograms, served at /metrics in the
+Prometheus text format. Recording is a relaxed atomic add, so any task can
+record without taking a lock. Values that already exist elsewhere, like the
+heap state, are read when the metrics are scraped. The page is a template
+streamed through a PageRenderer, one sample line at a time.
+*/
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+#include <atomic>
+
+#include "PageTemplate.h"
+
+#define METRICS_CONTENT_TYPE "text/plain; version=0.0.4"
+
+class Counter {
+ public:
+  void Add(uint32_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+  uint32_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint32_t> value_{0};
+};
+
+// Fixed bucket histogram of durations in microseconds
+class Histogram {
+ public:
+  static const uint8_t kBuckets = 15;
+  // Upper bounds in microseconds, the last bucket takes everything above
+  static const uint32_t kBounds[kBuckets - 1];
+  // Sample lines written by Format(), the buckets, the sum and the count
+  static const size_t kLines = kBuckets + 2;
+
+  void Observe(uint32_t micros);
+  // Writes sample line number line of the histogram called name, labels
+  // are added to every line if not empty. Returns PageRenderer::kNoItem
+  // after the last line.
+  size_t Format(size_t line, const char *name, const char *labels, char *buf,
+                size_t size) const;
+
+ private:
+  std::atomic<uint32_t> counts_[kBuckets] = {};
+  // 64 bit atomics are emulated with a short critical section on the
+  // ESP32, but 32 bit of microseconds would wrap after 71 minutes.
+  std::atomic<uint64_t> sum_{0};
+};
+
+class Metrics {
+ public:
+  enum Route : uint8_t {
+    kRouteIndex,
+    kRouteWake,
+    kRouteConfig,
+    kRouteLogin,
+    kRouteAsset,
+    kRouteApiDevices,
+    kRouteApiStatus,
+    kRouteApiWake,
+    kRouteMetrics,
+    kRouteNotFound,
+    kRouteCount
+  };
+  enum DisplayPage : uint8_t {
+    kPageStatus,
+    kPageDevices,
+    kPageNetwork,
+    kPageMessage,
+    kPageCount
+  };
+
+  // Writes the sample line of the device at index, returns
+  // PageRenderer::kNoItem if there is no such device.
+  typedef size_t (*DeviceFn)(size_t index, char *buf, size_t size);
+
+  // Records the run time of a request handler under route, from its
+  // construction until it goes out of scope. Responses streamed after the
+  // handler returns are not included.
+  class RequestTimer {
+   public:
+    explicit RequestTimer(Route route)
+        : route_(route), start_(esp_timer_get_time()) {}
+    ~RequestTimer() {
+      http_latency[route_].Observe(esp_timer_get_time() - start_);
+    }
+
+   private:
+    Route route_;
+    int64_t start_;
+  };
+
+  static void Setup(DeviceFn devices);
+  static void NtpSynced() {
+    ntp_synced_ = esp_timer_get_time() / 1000000 + 1;
+  }
+  static void Send(AsyncWebServerRequest *request);
+  // Writes value as a label value, with \, " and newlines escaped
+  static size_t EscapeLabel(const char *value, char *buf, size_t size);
+
+  static Counter udp_failures;      // failed UDP sends
+  static Counter frame_failures;    // failed raw Ethernet frame sends
+  static Counter link_downs;        // Ethernet disconnects
+  static Counter wakes_coalesced;   // joined a wake in its quiet window
+  static Counter requests_limited;  // refused by the per client limit
+  static Histogram loop_latency;    // one run of loop()
+  static Histogram http_latency[kRouteCount];
+  static Counter display_bytes[kPageCount];  // sent over I2C
+  static Histogram display_refresh[kPageCount];
+
+ private:
+  static size_t Fill(uint8_t placeholder, size_t item, char *buf, size_t size);
+
+  static PageTemplate page_;
+  static DeviceFn devices_;
+  static std::atomic<uint32_t> ntp_synced_;  // uptime + 1 s, 0 if never
+};
+
+#endif /* SRC_METRICS_H_ */
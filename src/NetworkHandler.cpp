@@ -15,12 +15,18 @@
 #include <FS.h>
 #include <SD.h>
 
+#include <algorithm>
 #include <ctime>
-#include <regex>
-#include <sstream>
+#include <memory>
 
+#include "ConfigCache.h"
 #include "Display.h"
+#include "EthFrameSink.h"
+#include "JsonWriter.h"
+#include "UdpBurstSender.h"
 #include "WakeOnLanGenerator.h"
+#include "WebAssets.h"
+#include "WebSession.h"
 #include "esp_sntp.h"
 
 extern I2CDisplay display;
@@ -29,29 +35,30 @@ bool NetworkHandler::eth_connected_ = false;
 bool NetworkHandler::ntp_connected_ = false;
 
 AsyncWebServer NetworkHandler::web_server_(WEB_SERVER_PORT);
-std::vector<WolDevice> NetworkHandler::wol_devices_;
-IPAddress NetworkHandler::target_broadcast_ = kDefaultBroadcastAddress;
+PageTemplate NetworkHandler::index_page_;
+PageTemplate NetworkHandler::device_list_page_;
+RateLimiter NetworkHandler::web_limiter_;
+RcuPointer<ConfigSnapshot> NetworkHandler::snapshot_;
+uint32_t NetworkHandler::snapshot_version_ = 0;
 AsyncUDP NetworkHandler::udp_;
-String NetworkHandler::boot_time_;
+static EthFrameSink eth_frame_sink;
+FrameSink *NetworkHandler::frame_sink_ = &eth_frame_sink;
+char NetworkHandler::boot_time_[TimeFormat::kDateTimeSize] = "";
+SeqLock<SystemStatus> NetworkHandler::status_;
+time_t NetworkHandler::status_time_ = 0;
 time_t NetworkHandler::next_wol_time_;
-bool NetworkHandler::first_wol_sent_ = false;
-NetworkConfig NetworkHandler::config_;
-
-bool operator<(const WolDevice &left, const WolDevice &right) {
-  if (left.mac < right.mac) return true;
-
-  return false;
-}
-
-bool operator==(const WolDevice &left, const WolDevice &right) {
-  if (left.mac == right.mac) return true;
-
-  return false;
-}
+volatile bool NetworkHandler::first_wol_sent_ = false;
+bool NetworkHandler::config_cached_ = false;
+const char *NetworkHandler::config_file_ = nullptr;
+time_t NetworkHandler::config_mtime_ = 0;
+size_t NetworkHandler::config_size_ = 0;
+int64_t NetworkHandler::next_config_poll_ = 0;
+File NetworkHandler::upload_file_;
+AsyncWebServerRequest *NetworkHandler::upload_writer_ = nullptr;
+AsyncWebServerRequest *NetworkHandler::upload_request_ = nullptr;
+std::atomic<bool> NetworkHandler::upload_pending_(false);
 
 bool NetworkHandler::Setup(const char *config_file) {
-  YAMLNode yaml_config;
-
   pinMode(SD_MISO_PIN, INPUT_PULLUP);
   SPI.begin(SD_SCLK_PIN, SD_MISO_PIN, SD_MOSI_PIN);
   bool first = true;
@@ -65,219 +72,317 @@ bool NetworkHandler::Setup(const char *config_file) {
     delay(1000);
   }
 
-  File file = SD.open(config_file);
-  if (!file) {
-    char msg[] = "Can't open YAML\nconfig file.";
-    display.UpdateMsgPage("Error:", msg);
-    delay(2000);
-    return false;  // fatal, abort mission
-  }
-
-  int num_bytes;
-  if (!(num_bytes = deserializeYml(yaml_config, file))) {
-    char msg[] = "Unable to deserialize\nYAML file.";
-    display.UpdateMsgPage("Error:", msg);
-    delay(2000);
-    return false;  // fatal, abort mission
-  }
-
-  if ("network:ip" != yaml_config.gettext("network:ip")) {
-    config_.ip.fromString(yaml_config.gettext("network:ip"));
-  } else {
-    char msg[] = "No network:ip\nin YAML config.";
-    display.UpdateMsgPage("Error:", msg);
+  config_file_ = config_file;
+  RememberConfigFile();
+  std::unique_ptr<ConfigSnapshot> snapshot(new ConfigSnapshot());
+  std::vector<WolDevice> wol_devices;
+  if (!LoadConfig(config_file, snapshot->config, wol_devices)) {
     return false;
   }
+  WebSession::Setup(snapshot->config.web_user,
+                    snapshot->config.web_password_hash);
+  web_limiter_.Setup(snapshot->config.web_rate, snapshot->config.web_burst);
+  // SD.end();
+  // SPI.end();
 
-  if ("network:gateway" != yaml_config.gettext("network:gateway")) {
-    config_.gateway.fromString(yaml_config.gettext("network:gateway"));
-  } else {
-    char msg[] = "No\n'network:gateway'\nin YAML config.";
-    display.UpdateMsgPage("Error:", msg);
+  if (!BuildSnapshot(*snapshot, wol_devices)) {
     return false;
   }
+  const NetworkConfig &config = snapshot->config;
 
-  if ("network:netmask" != yaml_config.gettext("network:netmask")) {
-    config_.subnet.fromString(yaml_config.gettext("network:netmask"));
-  } else {
-    char msg[] = "No\nnetwork:netmask\nin YAML config.";
-    display.UpdateMsgPage("Error:", msg);
+  std::vector<ProbeTarget> probe_targets;
+  probe_targets.reserve(wol_devices.size());
+  for (const WolDevice &device : wol_devices) {
+    probe_targets.push_back(device.probe);
+  }
+  if (!SetupWakeSequencer(config, wol_devices)) {
     return false;
   }
 
-  if ("network:DNS" != yaml_config.gettext("network:DNS")) {
-    config_.dns.fromString(yaml_config.gettext("network:DNS"));
-  } else {
-    char msg[] = "No network:DNS\nin YAML config.";
+  if (!WakeEngine::Setup(TransmitWol, OnWolJobDone, config.wol_rate,
+                         config.wol_burst)) {
+    char msg[] = "Unable to start\nWOL engine.";
     display.UpdateMsgPage("Error:", msg);
     return false;
   }
 
-  if ("network:hostname" != yaml_config.gettext("network:hostname")) {
-    config_.hostname = yaml_config.gettext("network:hostname");
-  } else {
-    char msg[] = "No hostname in\nYAML config.";
-    display.UpdateMsgPage("Error:", msg);
+  // The Ethernet event handler already reads the hostname from the snapshot.
+  snapshot->version = ++snapshot_version_;
+  snapshot_.Publish(snapshot.release());
+
+  // So far so good, setup network
+  if (!SetupEth()) {
     return false;
   }
+  // Frame headers need the MAC of the driver, publish them as a new snapshot.
+  bool raw_frames = false;
+  {
+    SnapshotGuard current = Snapshot();
+    for (const WolTarget &target : current->targets) {
+      raw_frames = raw_frames || target.transport == kTransportEthernet;
+    }
+    if (raw_frames) {
+      snapshot.reset(new ConfigSnapshot(*current));
+    }
+  }
+  if (raw_frames) {
+    BuildEthernetHeaders(*snapshot);
+    snapshot->version = ++snapshot_version_;
+    snapshot_.Publish(snapshot.release());
+  }
 
-  if ("network:NTP1" != yaml_config.gettext("network:NTP1")) {
-    if ("network:NTP2" != yaml_config.gettext("network:NTP2")) {
-      config_.ntp1 = yaml_config.gettext("network:NTP1");
-      config_.ntp2 = yaml_config.gettext("network:NTP2");
-    } else {
-      config_.ntp1 = yaml_config.gettext("network:NTP1");
+  // Started on the final snapshot, rewakes are tagged with its version.
+  {
+    SnapshotGuard current = Snapshot();
+    const NetworkConfig &config = current->config;
+    if (!ProbeEngine::Setup(probe_targets, current->version, RewakeWol,
+                            config.probe_backoff, config.probe_max_backoff,
+                            config.probe_timeout)) {
+      char msg[] = "Unable to start\nprobe engine.";
+      display.UpdateMsgPage("Error:", msg);
+      return false;
     }
-  } else {
-    char msg[] = "No NTP server in\nYAML config.";
-    display.UpdateMsgPage("Error:", msg);
-    return false;
   }
 
-  if ("timezone" != yaml_config.gettext("timezone")) {
-    config_.timezone = yaml_config.gettext("timezone");
-  } else {
-    char msg[] = "No timezone in\nYAML config.";
+  if (Snapshot()->config.web_enabled) SetupWebServer();
+  SetupOta();
+  return true;
+}
+
+// Loads the config from the binary cache if it was built from the same YAML
+// file, parses the YAML file and updates the cache otherwise.
+bool NetworkHandler::LoadConfig(const char *config_file, NetworkConfig &config,
+                                std::vector<WolDevice> &devices) {
+  File file = SD.open(config_file);
+  if (!file) {
+    char msg[] = "Can't open YAML\nconfig file.";
     display.UpdateMsgPage("Error:", msg);
     return false;
   }
 
-  if ("ota_password_hash" != yaml_config.gettext("ota_password_hash")) {
-    config_.ota_password = yaml_config.gettext("ota_password_hash");
-  } else {
-    char msg[] = "No ota_password_hash\nin YAML config.";
-    display.UpdateMsgPage("Error:", msg);
-    return false;
+  const uint32_t yaml_hash = ConfigCache::HashFile(file);
+  config_cached_ = ConfigCache::Load(SD, CONFIG_CACHE_FILE, yaml_hash,
+                                     config, devices);
+  if (config_cached_) {
+    file.close();
+    Serial.printf("Config: %u devices loaded from cache.\n",
+                  static_cast<unsigned>(devices.size()));
+    return true;
   }
 
-  if ("wol:startup" != yaml_config.gettext("wol:startup")) {
-    config_.wol_startup = atol(yaml_config.gettext("wol:startup"));
-  } else {
-    char msg[] = "No WOL startup time\nin YAML config.";
-    display.UpdateMsgPage("Error:", msg);
+  ConfigLoadStats stats;
+  char error[ConfigLoader::kErrorSize];
+  file.seek(0);
+  bool loaded = ConfigLoader::Load(file, config, devices, error, &stats);
+  file.close();
+  if (!loaded) {
+    display.UpdateMsgPage("Error:", error);
     return false;
   }
+  // Neither the snapshot nor the cache keep the plaintext password
+  WebSession::Hash(config.web_password, config.web_password_hash);
+  config.web_password = "";
+  Serial.printf("Config: %u devices, %u events, parsed in %u us, "
+                "peak heap %u bytes.\n",
+                static_cast<unsigned>(devices.size()),
+                static_cast<unsigned>(stats.events),
+                static_cast<unsigned>(stats.parse_us),
+                static_cast<unsigned>(stats.peak_heap));
+  if (!ConfigCache::Store(SD, CONFIG_CACHE_FILE, yaml_hash, config,
+                          devices)) {
+    Serial.println("Unable to write config cache.");
+  }
+  return true;
+}
 
-  if ("wol:repeat" != yaml_config.gettext("wol:repeat")) {
-    config_.wol_repeat = atol(yaml_config.gettext("wol:repeat"));
-  } else {
-    char msg[] = "No WOL repeat time\nin YAML config.";
-    display.UpdateMsgPage("Error:", msg);
+bool NetworkHandler::BuildSnapshot(ConfigSnapshot &snapshot,
+                                   const std::vector<WolDevice> &devices) {
+  if (!BuildWolTargets(snapshot, devices) ||
+      !BuildDeviceTable(snapshot, devices)) {
     return false;
   }
+  snapshot.devices_html.Build(snapshot.devices);
+  snapshot.packets_sent =
+      std::make_shared<std::vector<Counter>>(snapshot.devices.size());
+  snapshot.wakes = std::make_shared<WakeCoalescer>(snapshot.devices.size());
+  Serial.printf("Device HTML: %u bytes.\n",
+                static_cast<unsigned>(snapshot.devices_html.MemoryUsage()));
+  return true;
+}
 
-  if ("wol:port" != yaml_config.gettext("wol:port")) {
-    config_.wol_port = atol(yaml_config.gettext("wol:port"));
-  } else {
-    char msg[] = "No WOL port in\nYAML config.";
-    display.UpdateMsgPage("Error:", msg);
+// Builds a snapshot from config_file next to the current one and swaps it in.
+// Readers keep the snapshot they hold, new readers get the new one. Network,
+// web server, OTA and rate settings are only applied on boot. Runs in the
+// Arduino loop task, the same task as the wake sequencer.
+bool NetworkHandler::ReloadConfig(const char *config_file) {
+  const uint32_t start = millis();
+  std::unique_ptr<ConfigSnapshot> snapshot(new ConfigSnapshot());
+  std::vector<WolDevice> wol_devices;
+  if (!LoadConfig(config_file, snapshot->config, wol_devices) ||
+      !BuildSnapshot(*snapshot, wol_devices)) {
+    return false;
+  }
+  BuildEthernetHeaders(*snapshot);
+  const NetworkConfig &config = snapshot->config;
+  // Nothing was changed so far, the sequencer is the first to take the new
+  // devices and fails without touching its current setup.
+  if (!SetupWakeSequencer(config, wol_devices)) {
     return false;
   }
 
-  if ("web:enabled" != yaml_config.gettext("web:enabled")) {
-    std::stringstream s(yaml_config.gettext("web:enabled"));
-    if (!(s >> std::boolalpha >> config_.web_enabled)) {
-      config_.web_enabled = false;
-    }
-    if (config_.web_enabled) {
-      if ("web:user" != yaml_config.gettext("web:user")) {
-        config_.web_user = yaml_config.gettext("web:user");
-      } else {
-        char msg[] = "No web:user in\nYAML config.";
-        display.UpdateMsgPage("Error:", msg);
-        return false;
-      }
-      if ("web:password" != yaml_config.gettext("web:password")) {
-        config_.web_password = yaml_config.gettext("web:password");
-      } else {
-        char msg[] = "No web:password\nin YAML config.";
-        display.UpdateMsgPage("Error:", msg);
-        return false;
+  std::vector<ProbeTarget> probe_targets;
+  std::vector<int32_t> previous;
+  probe_targets.reserve(wol_devices.size());
+  previous.reserve(wol_devices.size());
+  {
+    SnapshotGuard current = Snapshot();
+    for (size_t i = 0; i < wol_devices.size(); ++i) {
+      probe_targets.push_back(wol_devices[i].probe);
+      uint16_t index = current->devices.Find(snapshot->devices.Mac(i));
+      previous.push_back(index == DeviceTable::kNotFound ? -1 : index);
+      if (index != DeviceTable::kNotFound) {
+        // Packets sent between here and the publish are lost.
+        (*snapshot->packets_sent)[i].Add(
+            (*current->packets_sent)[index].value());
       }
     }
-  } else {
-    char msg[] = "No web:enabled in\nYAML config.";
-    display.UpdateMsgPage("Error:", msg);
-    return false;
+    const NetworkConfig &old = current->config;
+    if (config.ip != old.ip || config.gateway != old.gateway ||
+        config.subnet != old.subnet || config.dns != old.dns ||
+        config.hostname != old.hostname || config.ntp1 != old.ntp1 ||
+        config.ntp2 != old.ntp2 || config.timezone != old.timezone ||
+        config.ota_password != old.ota_password ||
+        config.web_enabled != old.web_enabled ||
+        config.wol_rate != old.wol_rate || config.wol_burst != old.wol_burst ||
+        !WebSession::Matches(config.web_user, config.web_password_hash)) {
+      Serial.println("Config: network, web, OTA and rate changes take effect "
+                     "after reboot.");
+    }
   }
+  web_limiter_.Setup(config.web_rate, config.web_burst);
 
-  bool wol_success = false;
-  bool last_element = false;
-  int i = 0;
-  while (!last_element) {
-    String yaml_path_name("devices:" + String(i) + ":name");
-    WolDevice device;
-    device.name = yaml_config.gettext(yaml_path_name.c_str());
-    String yaml_path_mac("devices:" + String(i++) + ":mac");
-    device.mac = yaml_config.gettext(yaml_path_mac.c_str());
-    if (device.name.isEmpty() || device.mac.isEmpty() ||
-        device.name == yaml_path_name  // gettext() returns path if not found
-        || device.mac == yaml_path_mac) {
-      last_element = true;
+  snapshot->version = ++snapshot_version_;
+  const size_t count = snapshot->devices.size();
+  snapshot_.Publish(snapshot.release());
+  // Wake jobs carry the version of the device list their indices refer to,
+  // the wake engine drops those of older versions. config stays valid, only
+  // this task publishes snapshots.
+  ProbeEngine::Reload(probe_targets, snapshot_version_, previous,
+                      config.probe_backoff, config.probe_max_backoff,
+                      config.probe_timeout);
+  Serial.printf("Config: version %u with %u devices active after %u ms.\n",
+                static_cast<unsigned>(snapshot_version_),
+                static_cast<unsigned>(count),
+                static_cast<unsigned>(millis() - start));
+  return true;
+}
+
+// Reloads an uploaded config, or config.yml when it changed on the SD card.
+void NetworkHandler::PollConfig() {
+  if (upload_pending_) {
+    if (ReloadConfig(CONFIG_UPLOAD_FILE)) {
+      SD.remove(config_file_);
+      SD.rename(CONFIG_UPLOAD_FILE, config_file_);
+      RememberConfigFile();
     } else {
-      wol_success = true;
-      wol_devices_.push_back(device);
+      SD.remove(CONFIG_UPLOAD_FILE);
+      Serial.println("Uploaded config rejected, keeping the current one.");
     }
+    upload_pending_ = false;  // the file is gone, the next upload may start
+    return;
   }
-  // SD.end();
-  // SPI.end();
 
-  if (!wol_success) {
-    char msg[] = "No target devices\nconfigured in\n YAML config.'.";
-    display.UpdateMsgPage("Error:", msg);
-    return false;
+  const int64_t now = esp_timer_get_time() / 1000000;
+  if (config_file_ == nullptr || now < next_config_poll_) {
+    return;
+  }
+  next_config_poll_ = now + CONFIG_POLL_INTERVAL;
+  // A failed reload keeps the current config, but remembers the new file, so
+  // a broken file isn't parsed again until it changes.
+  if (RememberConfigFile() && !ReloadConfig(config_file_)) {
+    Serial.println("Changed config rejected, keeping the current one.");
   }
+}
 
-  // So far so good, setup network
-  if (!SetupEth()) {
+// Stores modification time and size of config.yml. Returns true if they
+// changed since the last call.
+bool NetworkHandler::RememberConfigFile() {
+  File file = SD.open(config_file_);
+  if (!file) {
     return false;
   }
+  const time_t mtime = file.getLastWrite();
+  const size_t size = file.size();
+  file.close();
+  const bool changed = mtime != config_mtime_ || size != config_size_;
+  config_mtime_ = mtime;
+  config_size_ = size;
+  return changed;
+}
 
-  if(config_.web_enabled) SetupWebServer();
-  SetupOta();
-  return true;
+// Streams a config upload to CONFIG_UPLOAD_FILE. Called from the async TCP
+// task, the reload itself runs in the Arduino loop. While the loop reads the
+// last upload, new ones are not written anywhere and get a 503.
+void NetworkHandler::HandleConfigUpload(AsyncWebServerRequest *request,
+                                        const String &filename, size_t index,
+                                        uint8_t *data, size_t len,
+                                        bool final) {
+  if (index == 0 && !upload_pending_) {
+    upload_file_.close();  // left open by an aborted upload
+    upload_writer_ = nullptr;
+    upload_request_ = nullptr;
+    if (Authenticate(request)) {
+      upload_file_ = SD.open(CONFIG_UPLOAD_FILE, FILE_WRITE);
+      upload_writer_ = request;
+    }
+  }
+  if (!upload_file_ || upload_writer_ != request) {
+    return;
+  }
+  upload_file_.write(data, len);
+  if (final) {
+    upload_file_.close();
+    upload_writer_ = nullptr;
+    upload_request_ = request;
+    upload_pending_ = true;
+  }
 }
 
-String NetworkHandler::GetTime(DateTimeType t, tm *ti) {
-  char ts[20];
+size_t NetworkHandler::GetTime(char *buf, size_t size, DateTimeType type,
+                               const tm *ti) {
   tm timeinfo;
   if (nullptr == ti) {
     ti = &timeinfo;
-    if (!ntp_connected_ || !getLocalTime(ti)) {
+    if (!ntp_connected_ || !getLocalTime(&timeinfo)) {
       // Serial.println("Failed to obtain time.");
-      return "";
+      buf[0] = '\0';
+      return 0;
     }
   }
-  switch (t) {
-    case all:
-      strftime(ts, 20, "%F %H:%M:%S", ti);
-      break;
+  return TimeFormat::DateTime(*ti, type, buf, size);
+}
+
+size_t NetworkHandler::GetUptime(char *buf, size_t size, DateTimeType type) {
+  if (boot_time_[0] == '\0') {
+    return TimeFormat::Duration(esp_timer_get_time() / 1000000, "", "ago",
+                                type, buf, size);
+  }
+  switch (type) {
     case date_only:
-      strftime(ts, 20, "%F", ti);
+      strlcpy(buf, boot_time_, size < 11 ? size : 11);
       break;
     case time_only:
-      strftime(ts, 20, "%H:%M:%S", ti);
+      strlcpy(buf, boot_time_ + 11, size);
       break;
+    default:
+      strlcpy(buf, boot_time_, size);
   }
-  return String(ts);
-}
-
-String NetworkHandler::GetUptime(DateTimeType type) {
-  if (boot_time_.length() > 0) {
-    switch (type) {
-      case all:
-        return boot_time_;
-      case date_only:
-        return boot_time_.substring(0, 10);
-      case time_only:
-        return boot_time_.substring(11);
-    }
-  }
-  return GetRelativeUptime(type);
+  return strlen(buf);
 }
 
-String NetworkHandler::GetNextWolTime(DateTimeType type) {
-  static int16_t time_left = 0;
+size_t NetworkHandler::GetNextWolTime(char *buf, size_t size,
+                                      DateTimeType type) {
+  static int32_t time_left = 0;
   if (next_wol_time_ < 100000) {
     // quick and dirty for detecting NTP not working (yet). Get relative time
 
@@ -285,84 +390,346 @@ String NetworkHandler::GetNextWolTime(DateTimeType type) {
     time(&epoche);
     if (epoche < next_wol_time_) {
       time_left = next_wol_time_ - epoche;
-      int16_t days = time_left / (24 * 3600);
-      time_left = time_left % (24 * 3600);
-      int hours = time_left / 3600;
-      time_left = time_left % 3600;
-      int minutes = time_left / 60;
-      time_left = time_left % 60;
-
-      std::vector<String> time_left_tokens;
-      time_left_tokens.push_back("in");
-      if (days) {
-        time_left_tokens.push_back(String(days) + "d");
-      }
-      if (hours) {
-        time_left_tokens.push_back(String(hours) + "h");
-      }
-      if (minutes) {
-        time_left_tokens.push_back(String(minutes) + "m");
-      }
-      time_left_tokens.push_back(String(time_left) + "s");
-
-      String time_left_str("");
-      switch (type) {
-        case date_only:
-          time_left_str += time_left_tokens[0];
-          if (time_left_tokens.size() > 1) {
-            time_left_str += " " + time_left_tokens[1];
-          }
-          break;
-        case time_only:
-          if (time_left_tokens.size() >= 2) {
-            for (int i = 2; i != time_left_tokens.size(); ++i) {
-              time_left_str += time_left_tokens[i] + " ";
-            }
-          }
-          break;
-        case all:
-          for (const String &token : time_left_tokens) {
-            time_left_str += token + " ";
-          }
-      }
-      return time_left_str;
+      return TimeFormat::Duration(time_left, "in", "", type, buf, size);
     } else {
       // We got system time now. Set next WOL epoche correctly and continue
       // returning absolute time string
       next_wol_time_ = epoche + time_left - 1;
     }
   }
-  return GetTime(type, localtime(&next_wol_time_));
+  tm ti;
+  localtime_r(&next_wol_time_, &ti);
+  return GetTime(buf, size, type, &ti);
 }
 
-void NetworkHandler::SendWol(const WolDevice &device) {
-  AsyncUDPMessage wakePacket =
-      WakeOnLanGenerator::generateWoLPacket(device.mac.c_str());
-  udp_.sendTo(wakePacket, ETH.broadcastIP(), config_.wol_port);
-  Serial.print("Sent WOL to ");
-  Serial.println(device.mac.c_str());
+// Called from the Arduino loop, formats the status once per second
+void NetworkHandler::PublishStatus() {
+  const time_t now = time(nullptr);
+  if (now == status_time_) {
+    return;
+  }
+  status_time_ = now;
+  SystemStatus status = {};
+  status.uptime = esp_timer_get_time() / 1000000;
+  strlcpy(status.ip, ETH.localIP().toString().c_str(), sizeof(status.ip));
+  if (ntp_connected_) {
+    tm ti;
+    localtime_r(&now, &ti);
+    GetTime(status.date, sizeof(status.date), date_only, &ti);
+    GetTime(status.time, sizeof(status.time), time_only, &ti);
+  }
+  strlcpy(status.boot, boot_time_, sizeof(status.boot));
+  GetUptime(status.boot_date, sizeof(status.boot_date), date_only);
+  GetUptime(status.boot_time, sizeof(status.boot_time), time_only);
+  // Also moves a relative next WOL time to the clock once NTP has synced
+  GetNextWolTime(status.next_wol, sizeof(status.next_wol));
+  GetNextWolTime(status.next_wol_date, sizeof(status.next_wol_date),
+                 date_only);
+  GetNextWolTime(status.next_wol_time, sizeof(status.next_wol_time),
+                 time_only);
+  status.wol_countdown = next_wol_time_ > now ? next_wol_time_ - now : 0;
+  status.link = eth_connected_;
+  status.ntp = ntp_connected_;
+  status.first_wol_sent = first_wol_sent_;
+  status.pending_packets = WakeEngine::PendingPackets();
+  status.last_completed_job = WakeEngine::LastCompletedJob();
+  status_.Write(status);
+}
+
+// Resolves the depends_on names of all devices and sets up the sequencer.
+bool NetworkHandler::SetupWakeSequencer(
+    const NetworkConfig &config, const std::vector<WolDevice> &devices) {
+  std::vector<std::vector<uint16_t>> depends_on(devices.size());
+  std::vector<int16_t> priorities;
+  priorities.reserve(devices.size());
+  for (size_t i = 0; i < devices.size(); ++i) {
+    for (const String &name : devices[i].depends_on) {
+      size_t j = 0;
+      while (j < devices.size() && devices[j].name != name) {
+        j++;
+      }
+      if (j == devices.size() || j == i) {
+        char msg[] = "Unknown device in\ndepends_on in YAML\nconfig.";
+        display.UpdateMsgPage("Error:", msg);
+        return false;
+      }
+      depends_on[i].push_back(j);
+    }
+    priorities.push_back(devices[i].priority);
+  }
+  if (!WakeSequencer::Setup(depends_on, priorities,
+                            config.max_concurrent_boots, config.boot_timeout,
+                            OnWakeRunDone)) {
+    char msg[] = "Circular depends_on\nin YAML config.";
+    display.UpdateMsgPage("Error:", msg);
+    return false;
+  }
+  return true;
+}
+
+bool NetworkHandler::BuildDeviceTable(ConfigSnapshot &snapshot,
+                                      const std::vector<WolDevice> &devices) {
+  DeviceTable &table = snapshot.devices;
+  table.Clear();
+  for (size_t i = 0; i < devices.size(); ++i) {
+    std::vector<std::string> tags;
+    for (const String &tag : devices[i].tags) {
+      tags.push_back(tag.c_str());
+    }
+    const uint64_t mac =
+        WakeOnLanGenerator::packMacAddr(snapshot.targets[i].mac);
+    if (!table.Add(mac, devices[i].name.c_str(), devices[i].group.c_str(),
+                   tags)) {
+      char msg[] = "Too many devices\nin YAML config.";
+      display.UpdateMsgPage("Error:", msg);
+      return false;
+    }
+  }
+  table.BuildIndexes();
+  const uint16_t duplicate = table.FindDuplicate();
+  if (duplicate != DeviceTable::kNotFound) {
+    char msg[40];
+    snprintf(msg, sizeof(msg), "Duplicate MAC of\n%s\nin YAML config.",
+             devices[duplicate].name.c_str());
+    display.UpdateMsgPage("Error:", msg);
+    return false;
+  }
+  Serial.printf("Device table: %u devices, %u bytes.\n",
+                static_cast<unsigned>(table.size()),
+                static_cast<unsigned>(table.MemoryUsage()));
+  return true;
+}
+
+bool NetworkHandler::BuildWolTargets(ConfigSnapshot &snapshot,
+                                     const std::vector<WolDevice> &devices) {
+  const NetworkConfig &config = snapshot.config;
+  std::vector<WolTarget> &targets = snapshot.targets;
+  // The local broadcast address follows from the static network config, so
+  // it doesn't have to be looked up for every packet.
+  const uint32_t broadcast = (uint32_t)config.ip | ~(uint32_t)config.subnet;
+
+  targets.clear();
+  targets.reserve(devices.size());
+  for (const WolDevice &device : devices) {
+    MacAddress mac;
+    if (!WakeOnLanGenerator::parseMacAddr(device.mac.c_str(), mac)) {
+      char msg[40];
+      snprintf(msg, sizeof(msg), "Invalid MAC for\n%s\nin YAML config.",
+               device.name.c_str());
+      display.UpdateMsgPage("Error:", msg);
+      targets.clear();
+      return false;
+    }
+    targets.emplace_back();
+    WolTarget &target = targets.back();
+    if (device.has_secureon) {
+      WakeOnLanGenerator::buildMagicPacket(mac, device.secureon,
+                                           target.payload());
+      target.payload_length = WakeOnLanGenerator::kMagicPacketSize +
+                              WakeOnLanGenerator::kSecureOnSize;
+    } else {
+      WakeOnLanGenerator::buildMagicPacket(mac, target.payload());
+      target.payload_length = WakeOnLanGenerator::kMagicPacketSize;
+    }
+    target.mac = mac;
+    // A VLAN id implies raw frames, the tag can't be set on UDP packets.
+    target.transport = device.vlan >= 0 || config.wol_raw
+                           ? kTransportEthernet
+                           : kTransportUdp;
+    target.vlan = device.vlan > 0 ? device.vlan : 0;
+    target.frame_offset = 0;
+    target.port = device.port ? device.port : config.wol_port;
+    target.ip = device.target_ip ? device.target_ip : broadcast;
+  }
+  return true;
+}
+
+// The source MAC is only known once the Ethernet driver is installed.
+void NetworkHandler::BuildEthernetHeaders(ConfigSnapshot &snapshot) {
+  MacAddress source;
+  ETH.macAddress(source.data());
+  bool raw_frames = false;
+  for (WolTarget &target : snapshot.targets) {
+    if (target.transport != kTransportEthernet) {
+      continue;
+    }
+    raw_frames = true;
+    target.frame_offset =
+        target.vlan ? 0 : WakeOnLanGenerator::kVlanTagSize;
+    WakeOnLanGenerator::buildEthernetHeader(
+        target.mac, source, target.vlan, target.buffer + target.frame_offset);
+  }
+  if (raw_frames && !EthFrameSink::kAvailable) {
+    Serial.println("This Arduino core can't send raw frames, wakes with vlan "
+                   "or transport ethernet will fail.");
+    char msg[] = "No raw Ethernet.\nvlan: and transport:\nethernet fail.";
+    display.UpdateMsgPage("Warning:", msg);
+  }
+}
+
+void NetworkHandler::SendWol(size_t index) {
+  RequestWake(*Snapshot(), index);
+}
+
+// Queues a wake of the device at index, unless one was requested within the
+// quiet window, which sets coalesced. Returns the id of the job that wakes
+// it, 0 if the queue is full or the joined job isn't queued yet.
+uint32_t NetworkHandler::RequestWake(const ConfigSnapshot &snapshot,
+                                     uint16_t index, bool *coalesced) {
+  uint32_t job = 0;
+  const bool claimed = snapshot.wakes->Claim(
+      index, millis(), snapshot.config.wol_quiet_window, job);
+  if (coalesced != nullptr) {
+    *coalesced = !claimed;
+  }
+  if (!claimed) {
+    Metrics::wakes_coalesced.Add();
+    return job;
+  }
+  job = WakeEngine::Enqueue(snapshot.version, index, 1);
+  snapshot.wakes->SetJob(index, job);
+  return job;
+}
+
+// Wakes all devices in the given group, or with the given tag if there is no
+// such group. Returns the number of devices woken.
+size_t NetworkHandler::SendWolGroup(const char *group_or_tag) {
+  SnapshotGuard snapshot = Snapshot();
+  DeviceRange range = snapshot->devices.FindGroup(group_or_tag);
+  if (range.size() == 0) {
+    range = snapshot->devices.FindTag(group_or_tag);
+  }
+  for (uint16_t index : range) {
+    RequestWake(*snapshot, index);
+  }
+  return range.size();
 }
 
 void NetworkHandler::SendWol() {
-  for (const WolDevice &device : wol_devices_) {
-    Serial.print("Sent WOL to: ");
-    Serial.println(device.mac.c_str());
-    AsyncUDPMessage wakePacket =
-        WakeOnLanGenerator::generateWoLPacket(device.mac.c_str());
-    udp_.sendTo(wakePacket, ETH.broadcastIP(), config_.wol_port);
-    delay(50);
+  SnapshotGuard snapshot = Snapshot();
+  if (WakeSequencer::Trivial()) {
+    WakeEngine::Enqueue(snapshot->version, 0, snapshot->targets.size(), true,
+                        true);
+  } else {
+    WakeSequencer::Start(true, snapshot->version);
+  }
+}
+
+// Repeats the wake of all devices, but only probes those known to be online.
+void NetworkHandler::SendPeriodicWol() {
+  SnapshotGuard snapshot = Snapshot();
+  if (WakeSequencer::Trivial()) {
+    WakeEngine::Enqueue(snapshot->version, 0, snapshot->targets.size(),
+                        false, true);
+  } else {
+    WakeSequencer::Start(false, snapshot->version);
   }
+}
+
+// Called from the Arduino loop once a sequenced wake of all devices is done
+void NetworkHandler::OnWakeRunDone() {
   first_wol_sent_ = true;
+  Serial.println("Sequenced WOL of all devices done.");
+}
+
+// Called from the probe engine task for devices that didn't come up
+void NetworkHandler::RewakeWol(uint32_t version, size_t index) {
+  WakeEngine::Enqueue(version, index, 1);
+}
+
+// Called from the wake engine task for every paced burst. The snapshot is
+// held until all packets are out, a reload waits for that before freeing it.
+// Jobs queued before a reload refer to the old device list and are dropped.
+bool NetworkHandler::TransmitWol(const WakeJob &job, size_t first,
+                                 size_t count) {
+  SnapshotGuard snapshot = Snapshot();
+  if (job.version != snapshot->version) {
+    return false;
+  }
+  if (first >= snapshot->targets.size()) {
+    return true;
+  }
+  count = std::min(count, snapshot->targets.size() - first);
+  if (job.force) {
+    TransmitWolRun(*snapshot, first, count);
+    return true;
+  }
+  // Send the runs of devices in between those that are online.
+  size_t run_start = first;
+  for (size_t i = first; i < first + count; ++i) {
+    if (ProbeEngine::IsOnline(i)) {
+      TransmitWolRun(*snapshot, run_start, i - run_start);
+      ProbeEngine::Verify(i);
+      run_start = i + 1;
+    }
+  }
+  TransmitWolRun(*snapshot, run_start, first + count - run_start);
+  return true;
+}
+
+void NetworkHandler::TransmitWolRun(const ConfigSnapshot &snapshot,
+                                    size_t first, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  const std::vector<WolTarget> &targets = snapshot.targets;
+  if (!UdpBurstSender::SendBurst(targets.data(), targets.size(),
+                                 snapshot.version, first, count)) {
+    // No pbuf pool, fall back to AsyncUDP, which copies every packet.
+    for (size_t i = first; i < first + count; ++i) {
+      const WolTarget &target = targets[i];
+      if (target.transport == kTransportUdp &&
+          udp_.writeTo(target.payload(), target.payload_size(),
+                       IPAddress(target.ip), target.port) == 0) {
+        Metrics::udp_failures.Add();
+      }
+    }
+  }
+  for (size_t i = first; i < first + count; ++i) {
+    const WolTarget &target = targets[i];
+    if (target.transport == kTransportEthernet &&
+        !frame_sink_->sendFrame(target.frame(), target.frame_size())) {
+      Metrics::frame_failures.Add();
+      char mac[DeviceTable::kMacStringSize];
+      snapshot.devices.FormatMac(i, mac);
+      Serial.print("Failed to send WOL frame to ");
+      Serial.println(mac);
+    }
+  }
+  for (size_t i = first; i < first + count; ++i) {
+    char mac[DeviceTable::kMacStringSize];
+    snapshot.devices.FormatMac(i, mac);
+    (*snapshot.packets_sent)[i].Add();
+    ProbeEngine::OnWolSent(i);
+    LiveEvents::PacketSent(i);
+    Serial.print("Sent WOL to ");
+    Serial.println(mac);
+  }
+}
+
+// Called from the wake engine task once all packets of a job are sent
+void NetworkHandler::OnWolJobDone(const WakeJob &job) {
+  if (job.periodic) {
+    first_wol_sent_ = true;
+  }
+  const UdpBurstSender::Stats &stats = UdpBurstSender::GetStats();
+  Serial.printf(
+      "WOL job %u done, %u packet(s) sent. %u packets/s, %d bytes heap "
+      "used by last burst.\n",
+      job.id, job.count, stats.packets_per_sec, stats.heap_delta);
 }
 
 // Setup callback function for ntp sync notification
 void NetworkHandler::CbSyncTime(struct timeval *tv) {
   NetworkHandler::SetNtpStatus(true);
+  Metrics::NtpSynced();
   Serial.println("NTP time synched");
 }
 
 bool NetworkHandler::SetupEth() {
   WiFi.onEvent(OnEthEvent);
+  SnapshotGuard snapshot = Snapshot();
+  const NetworkConfig &config = snapshot->config;
 
   if (!ETH.begin(ETH_TYPE, ETH_ADDR, ETH_MDC_PIN, ETH_MDIO_PIN, ETH_RESET_PIN,
                  ETH_CLK_MODE)) {
@@ -371,7 +738,7 @@ bool NetworkHandler::SetupEth() {
     return false;
   }
 
-  if (ETH.config(config_.ip, config_.gateway, config_.subnet, config_.dns) ==
+  if (ETH.config(config.ip, config.gateway, config.subnet, config.dns) ==
       false) {
     char msg[] = "ETH configuration\nfailed.";
     display.UpdateMsgPage("Error:", msg);
@@ -385,10 +752,12 @@ bool NetworkHandler::SetupNtp() {
   sntp_set_time_sync_notification_cb(CbSyncTime);
   sntp_set_sync_interval(1 * 60 * 60 * 1000UL);  // 1 hour
 
-  if (String("") != config_.ntp2) {
-    configTime(0, 0, config_.ntp1.c_str(), config_.ntp2.c_str());
+  SnapshotGuard snapshot = Snapshot();
+  const NetworkConfig &config = snapshot->config;
+  if (String("") != config.ntp2) {
+    configTime(0, 0, config.ntp1.c_str(), config.ntp2.c_str());
   } else {
-    configTime(0, 0, config_.ntp1.c_str());
+    configTime(0, 0, config.ntp1.c_str());
   }
   if (!getLocalTime(&timeInfo)) {
     char msg[] = "Failed to setup NTP.\nNetwork connected?.";
@@ -396,8 +765,8 @@ bool NetworkHandler::SetupNtp() {
     return true;  // temp failure. Might come back
   }
 
-  if (String("") != config_.timezone) {
-    setenv("TZ", config_.timezone.c_str(), 1);
+  if (String("") != config.timezone) {
+    setenv("TZ", config.timezone.c_str(), 1);
     tzset();
   }
 
@@ -406,7 +775,7 @@ bool NetworkHandler::SetupNtp() {
   int64_t uptime = esp_timer_get_time() / 1000000;
   time_t boot_time_epoche = epoche - uptime;
   struct tm *ti = localtime(&boot_time_epoche);
-  boot_time_ = GetTime(all, ti);
+  GetTime(boot_time_, sizeof(boot_time_), all, ti);
   // Serial.print(epoche);
   // Serial.print(" sec since the Epoche. ");
   // Serial.println(GetTime().c_str());
@@ -421,7 +790,7 @@ void NetworkHandler::OnEthEvent(WiFiEvent_t event) {
     case ARDUINO_EVENT_ETH_START:
       Serial.println("ETH Started");
       // set eth hostname here
-      ETH.setHostname(config_.hostname.c_str());
+      ETH.setHostname(Snapshot()->config.hostname.c_str());
       break;
     case ARDUINO_EVENT_ETH_CONNECTED:
       Serial.println("ETH Connected");
@@ -443,6 +812,7 @@ void NetworkHandler::OnEthEvent(WiFiEvent_t event) {
     case ARDUINO_EVENT_ETH_DISCONNECTED:
       Serial.println("ETH Disconnected");
       eth_connected_ = false;
+      Metrics::link_downs.Add();
       break;
     case ARDUINO_EVENT_ETH_STOP:
       Serial.println("ETH Stopped");
@@ -453,85 +823,209 @@ void NetworkHandler::OnEthEvent(WiFiEvent_t event) {
   }
 }
 
+enum IndexPlaceholder : uint8_t {
+  kDevicesPlaceholder,
+  kMessagePlaceholder,
+  kMessageTypePlaceholder,
+};
+static const char *const kPlaceholders[] = {"DEVICES", "MESSAGE",
+                                            "MESSAGE_TYPE"};
+static const size_t kPlaceholderCount = 3;
+
+static const WebAsset *FindAsset(const char *path) {
+  for (const WebAsset &asset : kWebAssets) {
+    if (strcmp(asset.path, path) == 0) {
+      return &asset;
+    }
+  }
+  return nullptr;
+}
+
+// Sends an embedded asset, or 304 if the browser has this version cached.
+void NetworkHandler::SendAsset(AsyncWebServerRequest *request,
+                               const WebAsset &asset, int code) {
+  const AsyncWebHeader *if_none_match = request->getHeader("If-None-Match");
+  if (code == 200 && if_none_match != nullptr &&
+      if_none_match->value() == asset.etag) {
+    AsyncWebServerResponse *response = request->beginResponse(304);
+    response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", WEB_CACHE_CONTROL);
+    request->send(response);
+    return;
+  }
+  AsyncWebServerResponse *response = request->beginResponse_P(
+      code, asset.content_type, asset.data, asset.size);
+  if (asset.gzip) {
+    response->addHeader("Content-Encoding", "gzip");
+  }
+  if (code == 200) {
+    response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", WEB_CACHE_CONTROL);
+  }
+  request->send(response);
+}
+
+// Accepts a session cookie from the login page, or Basic credentials from
+// scripts.
+bool NetworkHandler::Authenticate(AsyncWebServerRequest *request) {
+  const AsyncWebHeader *cookie = request->getHeader("Cookie");
+  if (cookie != nullptr && WebSession::CheckCookie(cookie->value().c_str())) {
+    return true;
+  }
+  const AsyncWebHeader *authorization = request->getHeader("Authorization");
+  return authorization != nullptr &&
+         WebSession::CheckBasic(authorization->value().c_str());
+}
+
+// Answers 429 if the client sent too many wake or login requests.
+bool NetworkHandler::RateLimited(AsyncWebServerRequest *request) {
+  if (web_limiter_.Allow(request->client()->remoteIP())) {
+    return false;
+  }
+  Metrics::requests_limited.Add();
+  AsyncWebServerResponse *response =
+      request->beginResponse(429, "text/plain", "Too many requests.\n");
+  response->addHeader("Retry-After", "1");
+  request->send(response);
+  return true;
+}
+
+// Sends browsers asking for the page to the login page, everything else gets
+// a Basic authentication challenge.
+void NetworkHandler::RequestLogin(AsyncWebServerRequest *request) {
+  if (request->method() == HTTP_GET &&
+      (request->url() == "/" || request->url() == "/index.html")) {
+    request->redirect("/login.html");
+  } else {
+    request->requestAuthentication(nullptr, false);
+  }
+}
+
 void NetworkHandler::SetupWebServer() {
-  web_server_.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-    if (!request->authenticate(config_.web_user.c_str(),
-                               config_.web_password.c_str()))
-      return request->requestAuthentication();
-    request->send(SD, "/www/index.html", "text/html", false,
-                  NetworkHandler::HTMLProcessor);
-  });
+  // The assets are embedded by shared/embed_web_assets.py, none of them is
+  // read from the SD card.
+  const WebAsset *index_html = FindAsset("/index.html");
+  const WebAsset *not_found_html = FindAsset("/not_found.html");
+  index_page_.Parse(reinterpret_cast<const char *>(index_html->data),
+                    index_html->size, kPlaceholders, kPlaceholderCount);
+  ArRequestHandlerFunction send_index = [](AsyncWebServerRequest *request) {
+    Metrics::RequestTimer timer(Metrics::kRouteIndex);
+    if (!Authenticate(request)) return RequestLogin(request);
+    SendIndexPage(request, Snapshot()->version, std::vector<bool>(), "", "");
+  };
+  web_server_.on("/", HTTP_GET, send_index);
+  web_server_.on("/index.html", HTTP_GET, send_index);
   web_server_.on("/", HTTP_POST, [](AsyncWebServerRequest *request) {
-    if (!request->authenticate(config_.web_user.c_str(),
-                               config_.web_password.c_str()))
-      return request->requestAuthentication();
-    if (SD.exists("/www/index.html")) {
-      File file = SD.open("/www/index.html");
-      if (file) {
-        String content = file.readString();
-        file.close();
-        String devices = "";
-        for (const WolDevice &wol_device : wol_devices_) {
-          devices += "        <label class='toggle'>\n";
-          devices += "          <span class='text'>";
-          devices += wol_device.name.c_str();
-          devices += " (";
-          devices += wol_device.mac.c_str();
-          devices += ")</span>\n";
-          devices += "          <input type='checkbox' id='";
-          devices += wol_device.mac.c_str();
-          devices += "' name='";
-          devices += wol_device.mac.c_str();
-          if (request->hasParam(wol_device.mac.c_str(), true) &&
-              String("on") ==
-                  request->getParam(wol_device.mac.c_str(), true)->value()) {
-            if (WakeOnLanGenerator::isValidMac(wol_device.mac.c_str())) {
-              SendWol(wol_device);
-            }
-            devices += "' checked />\n";
-          } else {
-            devices += "' />\n";
+    Metrics::RequestTimer timer(Metrics::kRouteWake);
+    if (RateLimited(request)) return;
+    if (!Authenticate(request)) return RequestLogin(request);
+    // Look up the checked devices by MAC, instead of asking the request
+    // for the parameter of every device.
+    SnapshotGuard snapshot = Snapshot();
+    const DeviceTable &table = snapshot->devices;
+    std::vector<bool> checked(table.size());
+    for (size_t p = 0; p < request->params(); ++p) {
+      const AsyncWebParameter *param = request->getParam(p);
+      MacAddress mac;
+      if (!param->isPost() || param->value() != "on" ||
+          !WakeOnLanGenerator::parseMacAddr(param->name().c_str(), mac)) {
+        continue;
+      }
+      uint16_t index = table.Find(WakeOnLanGenerator::packMacAddr(mac));
+      if (index != DeviceTable::kNotFound) {
+        checked[index] = true;
+        RequestWake(*snapshot, index);
+      }
+    }
+    SendIndexPage(request, snapshot->version, std::move(checked), "success",
+                  "WOL packets sent");
+  });
+
+  // Replaces config.yml, e.g. curl -u user:pass -F file=@config.yml .../config
+  web_server_.on(
+      "/config", HTTP_POST,
+      [](AsyncWebServerRequest *request) {
+        Metrics::RequestTimer timer(Metrics::kRouteConfig);
+        if (!Authenticate(request)) return RequestLogin(request);
+        if (upload_request_ != request) {
+          if (upload_pending_) {
+            return request->send(503, "text/plain",
+                                 "Reload in progress, upload rejected.\n");
           }
-          devices += "          <span class='value'></span>\n";
-          devices += "        </label>\n";
-          devices += "        <br>\n";
+          return request->send(409, "text/plain", "Upload rejected.\n");
         }
-        content.replace("%DEVICES%", devices);
-        content.replace("%MESSAGE_TYPE%", "success");
-        content.replace("%MESSAGE%", "WOL packets sent");
-        request->send(200, "text/html", content);
-        return;
-      }
+        upload_request_ = nullptr;
+        request->send(202, "text/plain", "Config uploaded, reloading.\n");
+      },
+      HandleConfigUpload);
+
+  web_server_.on("/login", HTTP_POST, [](AsyncWebServerRequest *request) {
+    Metrics::RequestTimer timer(Metrics::kRouteLogin);
+    if (RateLimited(request)) return;
+    const AsyncWebParameter *user = request->getParam("user", true);
+    const AsyncWebParameter *password = request->getParam("password", true);
+    if (user == nullptr || password == nullptr ||
+        !WebSession::CheckPassword(user->value().c_str(),
+                                   password->value().c_str())) {
+      return request->redirect("/login.html#failed");
     }
-    request->send(404);
+    char token[WebSession::kTokenSize];
+    WebSession::IssueToken(token);
+    AsyncWebServerResponse *response = request->beginResponse(303);
+    response->addHeader("Location", "/");
+    response->addHeader("Set-Cookie",
+                        String(WEB_SESSION_COOKIE "=") + token +
+                            "; Path=/; HttpOnly; SameSite=Strict; Max-Age=" +
+                            WEB_SESSION_LIFETIME);
+    request->send(response);
   });
 
-  web_server_.on("/main.css", HTTP_GET, [](AsyncWebServerRequest *request) {
-    if (!request->authenticate(config_.web_user.c_str(),
-                               config_.web_password.c_str()))
-      return request->requestAuthentication();
-    request->send(SD, "/www/main.css", "text/css");
+  web_server_.on("/logout", HTTP_POST, [](AsyncWebServerRequest *request) {
+    Metrics::RequestTimer timer(Metrics::kRouteLogin);
+    AsyncWebServerResponse *response = request->beginResponse(303);
+    response->addHeader("Location", "/login.html");
+    response->addHeader("Set-Cookie",
+                        WEB_SESSION_COOKIE "=; Path=/; Max-Age=0");
+    request->send(response);
   });
 
-  web_server_.on("/wol.png", HTTP_GET, [](AsyncWebServerRequest *request) {
-    if (!request->authenticate(config_.web_user.c_str(),
-                               config_.web_password.c_str()))
-      return request->requestAuthentication();
-    request->send(SD, "/www/wol.png", "image/png");
+  // The assets hold no secrets and the login page needs them, so they are
+  // served without authentication.
+  for (const WebAsset &asset : kWebAssets) {
+    if (asset.is_template) {
+      continue;
+    }
+    web_server_.on(asset.path, HTTP_GET, [&asset](AsyncWebServerRequest *req) {
+      Metrics::RequestTimer timer(Metrics::kRouteAsset);
+      SendAsset(req, asset);
+    });
+  }
+
+  SetupApi();
+  Metrics::Setup(FormatDeviceMetric);
+  web_server_.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+    Metrics::RequestTimer timer(Metrics::kRouteMetrics);
+    if (!Authenticate(request)) return RequestLogin(request);
+    Metrics::Send(request);
   });
+  if (LiveEvents::Setup(web_server_, Authenticate, FillLiveStatus,
+                        FormatDeviceMac)) {
+    ProbeEngine::SetOnlineCallback(LiveEvents::DeviceOnline);
+  }
 
-  web_server_.onNotFound([](AsyncWebServerRequest *request) {
-    if (!request->authenticate(config_.web_user.c_str(),
-                               config_.web_password.c_str()))
-      return request->requestAuthentication();
-    request->send(404);
+  web_server_.onNotFound([not_found_html](AsyncWebServerRequest *request) {
+    Metrics::RequestTimer timer(Metrics::kRouteNotFound);
+    SendAsset(request, *not_found_html, 404);
   });
   web_server_.begin();
 }
 
 void NetworkHandler::SetupOta() {
-  ArduinoOTA.setHostname(config_.hostname.c_str());
-  ArduinoOTA.setPasswordHash(config_.ota_password.c_str());
+  {
+    SnapshotGuard snapshot = Snapshot();
+    ArduinoOTA.setHostname(snapshot->config.hostname.c_str());
+    ArduinoOTA.setPasswordHash(snapshot->config.ota_password.c_str());
+  }
   ArduinoOTA.onStart([]() { Serial.println("Start updating firmware."); });
   ArduinoOTA.onProgress([](uint progress, uint total) {
     //    Serial.printf("Progress: %u%%\r", (progress / (total / 100)));
@@ -559,74 +1053,374 @@ void NetworkHandler::SetupOta() {
   MDNS.addService("http", "tcp", WEB_SERVER_PORT);
 }
 
-String NetworkHandler::GetRelativeUptime(const DateTimeType &type) {
-  int64_t uptime = esp_timer_get_time() / 1000000;
+void NetworkHandler::SendApiError(AsyncWebServerRequest *request, int code,
+                                  const char *error) {
+  AsyncResponseStream *response =
+      request->beginResponseStream("application/json");
+  response->setCode(code);
+  JsonWriter json(*response);
+  json.BeginObject();
+  json.Key("error");
+  json.Str(error);
+  json.EndObject();
+  request->send(response);
+}
 
-  int16_t days = uptime / (24 * 3600);
-  uptime = uptime % (24 * 3600);
+// Writes the JSON of /api/devices into the item buffers of a PageRenderer.
+// One JsonWriter spans the whole response, each device is written as two
+// items, as the escaped name and group of one device may not fit one.
+struct DeviceListWriter {
+  DeviceListWriter() : json(out) {}
 
-  int hours = uptime / 3600;
-  uptime = uptime % 3600;
+  BufferPrint out;
+  JsonWriter json;
+  uint32_t version = 0;  // of the snapshot the list started with
+  bool in_object = false;
+  bool done = false;
+};
 
-  int minutes = uptime / 60;
-  uptime = uptime % 60;
+// A name or group escapes to at most 6 bytes per char, \u00XX
+static_assert(6 * DeviceTable::kMaxNameLength + 128 <= PageRenderer::kItemSize,
+              "Half a device of /api/devices doesn't fit the item buffer");
 
-  std::vector<String> uptime_tokens;
-  if (days) {
-    uptime_tokens.push_back(String(days) + "d");
-  }
-  if (hours) {
-    uptime_tokens.push_back(String(hours) + "h");
-  }
-  if (minutes) {
-    uptime_tokens.push_back(String(minutes) + "m");
-  }
-  uptime_tokens.push_back(String(uptime) + "s");
-  uptime_tokens.push_back("ago");
+static const char *const kDeviceListPlaceholders[] = {"DEVICES"};
+static const char kDeviceListPage[] = "%DEVICES%";
 
-  String uptime_str("");
-  switch (type) {
-    case date_only:
-      uptime_str += uptime_tokens[0];
-      if (uptime_tokens.size() > 1) {
-        uptime_str += " " + uptime_tokens[1];
+// Streams the device list through a chunked response. The snapshot is taken
+// per item like for the index page. A reload in between ends the response
+// without closing the array, so clients see the error instead of a list
+// that mixes two configs.
+void NetworkHandler::SendDeviceList(AsyncWebServerRequest *request) {
+  std::shared_ptr<DeviceListWriter> writer =
+      std::make_shared<DeviceListWriter>();
+  PageRenderer::FillFn fill = [writer](uint8_t placeholder, size_t item,
+                                       char *buf, size_t size) -> size_t {
+    if (writer->done) {
+      return PageRenderer::kNoItem;
+    }
+    writer->out.Reset(buf, size);
+    JsonWriter &json = writer->json;
+    SnapshotGuard snapshot = Snapshot();
+    if (item == 0) {
+      writer->version = snapshot->version;
+      json.BeginArray();
+    } else if (snapshot->version != writer->version) {
+      writer->done = true;
+      return PageRenderer::kNoItem;
+    }
+    const DeviceTable &devices = snapshot->devices;
+    const size_t i = item / 2;
+    if (i >= devices.size()) {
+      if (writer->in_object) {
+        json.EndObject();
       }
-      break;
-    case time_only:
-      if (uptime_tokens.size() >= 2) {
-        for (int i = 2; i != uptime_tokens.size(); ++i) {
-          uptime_str += uptime_tokens[i] + " ";
+      json.EndArray();
+      writer->done = true;
+    } else if (!writer->in_object) {
+      char mac[DeviceTable::kMacStringSize];
+      devices.FormatMac(i, mac);
+      json.BeginObject();
+      json.Key("mac");
+      json.Str(mac);
+      json.Key("name");
+      json.Str(devices.Name(i));
+      writer->in_object = true;
+    } else {
+      char state[16];
+      ProbeEngine::FormatState(i, state, sizeof(state));
+      json.Key("group");
+      json.Str(devices.Group(i));
+      json.Key("probed");
+      json.Bool(ProbeEngine::IsProbed(i));
+      json.Key("online");
+      json.Bool(ProbeEngine::IsOnline(i));
+      json.Key("state");
+      json.Str(state);
+      json.EndObject();
+      writer->in_object = false;
+    }
+    return writer->out.length();
+  };
+  std::shared_ptr<PageRenderer> renderer =
+      std::make_shared<PageRenderer>(device_list_page_, fill);
+  request->send(request->beginChunkedResponse(
+      "application/json",
+      [renderer](uint8_t *buffer, size_t max_len, size_t index) {
+        return renderer->Read(buffer, max_len);
+      }));
+}
+
+// JSON API for scripts, see README.md for the format. The device list is
+// chunked, the other responses are written straight into the response
+// stream.
+void NetworkHandler::SetupApi() {
+  device_list_page_.Parse(kDeviceListPage, sizeof(kDeviceListPage) - 1,
+                          kDeviceListPlaceholders, 1);
+  web_server_.on("/api/devices", HTTP_GET, [](AsyncWebServerRequest *request) {
+    Metrics::RequestTimer timer(Metrics::kRouteApiDevices);
+    if (!Authenticate(request)) return RequestLogin(request);
+    SendDeviceList(request);
+  });
+
+  web_server_.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request) {
+    Metrics::RequestTimer timer(Metrics::kRouteApiStatus);
+    if (!Authenticate(request)) return RequestLogin(request);
+    AsyncResponseStream *response =
+        request->beginResponseStream("application/json");
+    JsonWriter json(*response);
+    SystemStatus status;
+    Status(status);
+    json.BeginObject();
+    json.Key("uptime");
+    json.UInt(status.uptime);
+    json.Key("boot_time");
+    json.Str(status.boot);
+    json.Key("next_wol");
+    json.Str(status.next_wol);
+    json.Key("wol_countdown");
+    json.UInt(status.wol_countdown);
+    json.Key("link");
+    json.Bool(status.link);
+    json.Key("ntp");
+    json.Bool(status.ntp);
+    json.Key("first_wol_sent");
+    json.Bool(status.first_wol_sent);
+    json.Key("pending_packets");
+    json.UInt(status.pending_packets);
+    json.Key("last_completed_job");
+    json.UInt(status.last_completed_job);
+    json.Key("config_version");
+    json.UInt(Snapshot()->version);
+    json.Key("coalesced_wakes");
+    json.UInt(Metrics::wakes_coalesced.value());
+    json.Key("limited_requests");
+    json.UInt(Metrics::requests_limited.value());
+    json.EndObject();
+    request->send(response);
+  });
+
+  // Takes mac=<mac>, which may be repeated or a comma separated list, and
+  // group=<group or tag>. Nothing is sent if one of them is unknown.
+  web_server_.on("/api/wake", HTTP_POST, [](AsyncWebServerRequest *request) {
+    Metrics::RequestTimer timer(Metrics::kRouteApiWake);
+    if (RateLimited(request)) return;
+    if (!Authenticate(request)) return RequestLogin(request);
+    std::vector<uint16_t> indices;
+    {
+      SnapshotGuard snapshot = Snapshot();
+      const DeviceTable &devices = snapshot->devices;
+      for (size_t p = 0; p < request->params(); ++p) {
+        const AsyncWebParameter *param = request->getParam(p);
+        if (param->name() == "group") {
+          DeviceRange range = devices.FindGroup(param->value().c_str());
+          if (range.size() == 0) {
+            range = devices.FindTag(param->value().c_str());
+          }
+          if (range.size() == 0) {
+            return SendApiError(request, 404, "unknown group");
+          }
+          indices.insert(indices.end(), range.begin(), range.end());
+        } else if (param->name() == "mac") {
+          const String &list = param->value();
+          int start = 0;
+          while (start <= static_cast<int>(list.length())) {
+            int end = list.indexOf(',', start);
+            if (end < 0) {
+              end = list.length();
+            }
+            String item = list.substring(start, end);
+            item.trim();
+            MacAddress mac;
+            uint16_t index = DeviceTable::kNotFound;
+            if (WakeOnLanGenerator::parseMacAddr(item.c_str(), mac)) {
+              index = devices.Find(WakeOnLanGenerator::packMacAddr(mac));
+            }
+            if (index == DeviceTable::kNotFound) {
+              return SendApiError(request, 404, "unknown mac");
+            }
+            indices.push_back(index);
+            start = end + 1;
+          }
         }
       }
-      break;
-    case all:
-      for (const String &token : uptime_tokens) {
-        uptime_str += token + " ";
+    }
+    if (indices.empty()) {
+      return SendApiError(request, 400, "mac or group required");
+    }
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    // Jobs run in order, the wake is done once last_completed_job in
+    // /api/status reaches the returned job. Devices woken within the quiet
+    // window join the job that wakes them. Devices that find the queue full
+    // are counted, those queued before them are woken either way.
+    uint32_t job = 0;
+    size_t coalesced = 0;
+    size_t not_queued = 0;
+    {
+      SnapshotGuard snapshot = Snapshot();
+      for (uint16_t index : indices) {
+        bool joined = false;
+        const uint32_t device_job = RequestWake(*snapshot, index, &joined);
+        if (joined) {
+          coalesced++;
+        } else if (device_job == 0) {
+          not_queued++;
+        }
+        job = std::max(job, device_job);
       }
+    }
+    if (not_queued == indices.size()) {
+      return SendApiError(request, 503, "wake queue full");
+    }
+    AsyncResponseStream *response =
+        request->beginResponseStream("application/json");
+    response->setCode(202);
+    JsonWriter json(*response);
+    json.BeginObject();
+    json.Key("job");
+    json.UInt(job);
+    json.Key("devices");
+    json.UInt(indices.size());
+    json.Key("coalesced");
+    json.UInt(coalesced);
+    json.Key("not_queued");
+    json.UInt(not_queued);
+    json.EndObject();
+    request->send(response);
+  });
+}
+
+// Called from the Arduino loop for the status pushed to the web interface
+void NetworkHandler::FillLiveStatus(LiveStatus &status) {
+  SystemStatus current;
+  Status(current);
+  strlcpy(status.next_wol, current.next_wol, sizeof(status.next_wol));
+  status.link = current.link;
+  status.ntp = current.ntp;
+  status.first_wol_sent = current.first_wol_sent;
+  status.pending_packets = current.pending_packets;
+  status.last_completed_job = current.last_completed_job;
+  status.config_version = Snapshot()->version;
+  status.coalesced_wakes = Metrics::wakes_coalesced.value();
+  status.limited_requests = Metrics::requests_limited.value();
+}
+
+void NetworkHandler::FormatDeviceMac(uint16_t index, char *buf) {
+  SnapshotGuard snapshot = Snapshot();
+  if (index < snapshot->devices.size()) {
+    snapshot->devices.FormatMac(index, buf);
+  } else {
+    buf[0] = '\0';
   }
-  return uptime_str;
-}
-
-String NetworkHandler::HTMLProcessor(const String &var) {
-  if (var == "DEVICES") {
-    String devices = "";
-    for (const WolDevice &wol_device : wol_devices_) {
-      devices += "        <label class='toggle'>\n";
-      devices += "          <span class='text'>";
-      devices += wol_device.name.c_str();
-      devices += " (";
-      devices += wol_device.mac.c_str();
-      devices += ")</span>\n";
-      devices += "          <input type='checkbox' id='";
-      devices += wol_device.mac.c_str();
-      devices += "' name='";
-      devices += wol_device.mac.c_str();
-      devices += "' checked />\n";
-      devices += "          <span class='value'></span>\n";
-      devices += "        </label>\n";
-      devices += "        <br>\n";
-    }
-    return devices;
-  }
-  return String();
+}
+
+size_t NetworkHandler::FormatDeviceMetric(size_t index, char *buf,
+                                          size_t size) {
+  SnapshotGuard snapshot = Snapshot();
+  if (index >= snapshot->devices.size()) {
+    return PageRenderer::kNoItem;
+  }
+  char mac[DeviceTable::kMacStringSize];
+  char name[128];
+  snapshot->devices.FormatMac(index, mac);
+  Metrics::EscapeLabel(snapshot->devices.Name(index), name, sizeof(name));
+  const uint32_t sent = (*snapshot->packets_sent)[index].value();
+  return snprintf(buf, size,
+                  "wol_packets_sent_total{mac=\"%s\",name=\"%s\"} %u\n", mac,
+                  name, static_cast<unsigned>(sent));
+}
+
+// Fits the state and histogram with every count at UINT32_MAX
+static const size_t kProbeStateSize = 224;
+
+static_assert(DeviceFragment::kMaxRowLength + kProbeStateSize <=
+                  PageRenderer::kItemSize,
+              "The longest device row doesn't fit the item buffer");
+
+// State and wake latency histogram of a probed device, empty otherwise
+size_t NetworkHandler::HTMLProbeState(size_t index, char *buf, size_t size) {
+  buf[0] = '\0';
+  if (!ProbeEngine::IsProbed(index)) {
+    return 0;
+  }
+  char state[16];
+  ProbeEngine::FormatState(index, state, sizeof(state));
+  LatencyHistogram histogram = ProbeEngine::Histogram(index);
+  size_t n = 0;
+  auto append = [&](const char *format, unsigned a, unsigned b) {
+    if (n < size) {
+      int len = snprintf(buf + n, size - n, format, a, b);
+      n += len > 0 ? len : 0;
+    }
+  };
+  append(" <small title='Wake to online latency: ", 0, 0);
+  for (uint8_t b = 0; b < LatencyHistogram::kBuckets - 1; ++b) {
+    append("<=%us: %u, ", LatencyHistogram::kBounds[b], histogram.counts[b]);
+  }
+  const uint8_t last = LatencyHistogram::kBuckets - 1;
+  append(">%us: %u'>", LatencyHistogram::kBounds[last - 1],
+         histogram.counts[last]);
+  if (n < size) {
+    n += snprintf(buf + n, size - n, "%s</small>", state);
+  }
+  return std::min(n, size - 1);
+}
+
+// Streams the index page through a chunked response. Devices past the end of
+// checked are shown checked. The rows come from the HTML cached in the
+// snapshot, only probe state and checked attribute are filled in per request.
+// The snapshot is taken per row, so a reload during a slow download doesn't
+// have to wait for it. checked refers to the devices of the given config
+// version, a reload to another one ends the list and asks for a reload of
+// the page instead.
+void NetworkHandler::SendIndexPage(AsyncWebServerRequest *request,
+                                   uint32_t version,
+                                   std::vector<bool> &&checked,
+                                   const char *message_type,
+                                   const char *message) {
+  struct IndexPageState {
+    std::vector<bool> checked;
+    bool reloaded = false;
+  };
+  std::shared_ptr<IndexPageState> state = std::make_shared<IndexPageState>();
+  state->checked = std::move(checked);
+  PageRenderer::FillFn fill = [state, version, message_type, message](
+                                  uint8_t placeholder, size_t item, char *buf,
+                                  size_t size) -> size_t {
+    if (placeholder == kDevicesPlaceholder) {
+      SnapshotGuard snapshot = Snapshot();
+      if (snapshot->version != version) {
+        state->reloaded = true;
+        return PageRenderer::kNoItem;
+      }
+      if (item >= snapshot->devices_html.size()) {
+        return PageRenderer::kNoItem;
+      }
+      char probe_state[kProbeStateSize];
+      HTMLProbeState(item, probe_state, sizeof(probe_state));
+      return snapshot->devices_html.Render(
+          item, probe_state,
+          item >= state->checked.size() || state->checked[item], buf, size);
+    }
+    if (item > 0) {
+      return PageRenderer::kNoItem;
+    }
+    if (state->reloaded) {
+      return strlcpy(buf,
+                     placeholder == kMessagePlaceholder
+                         ? "Config reloaded, please reload the page"
+                         : "error",
+                     size);
+    }
+    return strlcpy(buf,
+                   placeholder == kMessagePlaceholder ? message : message_type,
+                   size);
+  };
+  std::shared_ptr<PageRenderer> renderer =
+      std::make_shared<PageRenderer>(index_page_, fill);
+  request->send(request->beginChunkedResponse(
+      "text/html", [renderer](uint8_t *buffer, size_t max_len, size_t index) {
+        return renderer->Read(buffer, max_len);
+      }));
 }
@@ -19,10 +19,25 @@
 #include <SPI.h>
 #include <WiFi.h>
 #include <utilities.h>
-#define YAML_DISABLE_CJSON       // disable all cJSON functions
-#define YAML_DISABLE_ARDUINOJSON // disable all ArduinoJson functions
-#include <ArduinoYaml.h>  // Happy with plain YAML for out needs
+#include <FrameSink.h>
+#include <WakeOnLanGenerator.h>
+#include "ConfigLoader.h"
+#include "DeviceFragment.h"
+#include "DeviceTable.h"
+#include "LiveEvents.h"
+#include "Metrics.h"
+#include "PageTemplate.h"
+#include "ProbeEngine.h"
+#include "RateLimiter.h"
+#include "RcuPointer.h"
+#include "SeqLock.h"
+#include "TimeFormat.h"
+#include "WakeCoalescer.h"
+#include "WakeEngine.h"
+#include "WakeSequencer.h"
+#include <atomic>
 #include <ctime>
+#include <memory>
 
 #if ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3, 0, 0)
 #include <ETHClass2.h>  //Is to use the modified ETHClass
@@ -33,83 +48,197 @@
 
 #define DISPLAY_INTERVAL 1  // time between display updates in sec
 #define WEB_SERVER_PORT 80
-
-// Web Server constants
-static const IPAddress kDefaultBroadcastAddress =
-    (uint)0;  // set to 0 to use the local network broadcast ip instead.
+#define WEB_CACHE_CONTROL "max-age=3600"  // for the embedded web assets
+#define CONFIG_CACHE_FILE "/config.cache"
+#define CONFIG_UPLOAD_FILE "/config.yml.new"
+#define CONFIG_POLL_INTERVAL 5  // s between checks of config.yml for changes
 
 // Wake on Lan constants
 static const uint16_t kWolTargetPort = 9;
 
-// Network config
-struct NetworkConfig {
-  IPAddress ip;
-  IPAddress gateway;
-  IPAddress subnet;
-  IPAddress dns;
-  String ntp1;
-  String ntp2;
-  String hostname;
-  String timezone;
-  String ota_password;
-  uint16_t wol_startup;
-  uint16_t wol_repeat;
-  uint16_t wol_port;
-  bool web_enabled;
-  String web_user;
-  String web_password;
+// The embedded files of WebAssets.h, only included by NetworkHandler.cpp
+struct WebAsset;
+
+enum WolTransport : uint8_t { kTransportUdp, kTransportEthernet };
+
+// Prebuilt magic packet and resolved destination of a device. The buffer
+// leaves room for an Ethernet header with VLAN tag in front of the payload,
+// so raw frames go out from the same bytes as UDP packets.
+struct WolTarget {
+  static const size_t kHeaderRoom = WakeOnLanGenerator::kEthernetHeaderSize +
+                                    WakeOnLanGenerator::kVlanTagSize;
+  uint8_t buffer[kHeaderRoom + WakeOnLanGenerator::kMagicPacketSize +
+                 WakeOnLanGenerator::kSecureOnSize];
+  MacAddress mac;
+  WolTransport transport;
+  uint8_t frame_offset;    // start of the Ethernet frame in buffer
+  uint8_t payload_length;  // magic packet plus optional SecureOn password
+  uint16_t vlan;
+  uint16_t port;
+  uint32_t ip;
+
+  uint8_t *payload() { return buffer + kHeaderRoom; }
+  const uint8_t *payload() const { return buffer + kHeaderRoom; }
+  size_t payload_size() const { return payload_length; }
+  const uint8_t *frame() const { return buffer + frame_offset; }
+  size_t frame_size() const {
+    return kHeaderRoom - frame_offset + payload_length;
+  }
 };
 
-// Device information
-struct WolDevice {
-  String mac;
-  String name;
-  WolDevice(){};
-  WolDevice(const String &m, const String &n) : mac(m), name(n) {}
+// Everything derived from one version of the config. A snapshot is never
+// changed once published, a config reload publishes a new one.
+struct ConfigSnapshot {
+  uint32_t version;
+  NetworkConfig config;
+  DeviceTable devices;
+  DeviceFragment devices_html;  // checkbox list of the web interface
+  std::vector<WolTarget> targets;
+  // WOL packets sent per device, carried over by reloads
+  std::shared_ptr<std::vector<Counter>> packets_sent;
+  // Wakes requested within the quiet window. Queued jobs are dropped by a
+  // reload, so every reload starts a new one.
+  std::shared_ptr<WakeCoalescer> wakes;
 };
 
-bool operator<(const WolDevice &left, const WolDevice &right);
-bool operator==(const WolDevice &left, const WolDevice &right);
+typedef RcuPointer<ConfigSnapshot>::ReadGuard SnapshotGuard;
 
-enum DateTimeType { all, date_only, time_only };
+// What the display and the web interface show, formatted once per second by
+// the Arduino loop. Times are empty until NTP has synced, boot and next WOL
+// times are relative then.
+struct SystemStatus {
+  uint32_t uptime;          // s since boot
+  int32_t wol_countdown;    // s until the next periodic WOL
+  char ip[16];
+  char date[11];            // current date and time
+  char time[9];
+  char boot[20];            // boot time, "" without NTP at boot
+  char boot_date[16];
+  char boot_time[16];
+  char next_wol[32];
+  char next_wol_date[16];
+  char next_wol_time[16];
+  bool link;
+  bool ntp;
+  bool first_wol_sent;
+  uint32_t pending_packets;
+  uint32_t last_completed_job;
+};
 
 class NetworkHandler {
  public:
   static bool Setup(const char *config_file);
-  static NetworkConfig &Config() { return config_; };
+  // The current config and devices, valid as long as the guard is held.
+  // Never blocks, not even while a reload is in progress.
+  static SnapshotGuard Snapshot() { return snapshot_.Read(); }
+  static bool ReloadConfig(const char *config_file);
   static void SetNtpStatus(const bool &n) { ntp_connected_ = n; };
-  static String GetTime(DateTimeType t = all, tm *ti = nullptr);
-  static String GetUptime(DateTimeType t = all);
-  static void SetNextWolTime(const time_t &e) {NetworkHandler::next_wol_time_ = e;}
-  static String GetNextWolTime(DateTimeType t = all);
+  // Writes "" if the time isn't known yet
+  static size_t GetTime(char *buf, size_t size, DateTimeType t = all,
+                        const tm *ti = nullptr);
+  // Writes the time since boot instead if NTP wasn't synced at boot
+  static size_t GetUptime(char *buf, size_t size, DateTimeType t = all);
+  static void SetNextWolTime(const time_t &e) {
+    NetworkHandler::next_wol_time_ = e;
+    status_time_ = 0;  // show it with the next loop
+  }
+  // Writes a countdown instead while NTP isn't synced
+  static size_t GetNextWolTime(char *buf, size_t size, DateTimeType t = all);
   static void SendWol();
-  static void SendWol(const WolDevice &wol_device);
-  static const std::vector<WolDevice>& GetWolDevices() { return wol_devices_; }
+  static void SendPeriodicWol();
+  static void SendWol(size_t index);
+  static size_t SendWolGroup(const char *group_or_tag);
+  static void SetFrameSink(FrameSink *sink) { frame_sink_ = sink; }
   static bool FirstWolSent() { return first_wol_sent_; }
-  static void Loop() { ArduinoOTA.handle(); };
+  static bool ConfigCached() { return config_cached_; }
+  static bool WolPending() { return WakeEngine::PendingPackets() != 0; }
+  // Copies the status of the last second. Never blocks or allocates.
+  static void Status(SystemStatus &status) { status_.Read(status); }
+  static void Loop() {
+    ArduinoOTA.handle();
+    PublishStatus();
+    WakeSequencer::Tick();
+    LiveEvents::Tick();
+    PollConfig();
+  };
   static void CbSyncTime(timeval *tv);
 
 
  private:
-  static bool first_wol_sent_;
+  static volatile bool first_wol_sent_;
+  static bool config_cached_;
   static bool eth_connected_;
   static bool ntp_connected_;
   static time_t next_wol_time_;
 
   static AsyncWebServer web_server_;
-  static std::vector<WolDevice> wol_devices_;
-  static IPAddress target_broadcast_;
-  static String boot_time_;
+  static PageTemplate index_page_;
+  static PageTemplate device_list_page_;  // of /api/devices
+  static RateLimiter web_limiter_;  // of wake and login requests
+  static RcuPointer<ConfigSnapshot> snapshot_;
+  static uint32_t snapshot_version_;
+  static char boot_time_[TimeFormat::kDateTimeSize];
+  static SeqLock<SystemStatus> status_;
+  static time_t status_time_;  // second of the published status
   static AsyncUDP udp_;
-  static NetworkConfig config_;
-  
+  static FrameSink *frame_sink_;
+  static const char *config_file_;
+  static time_t config_mtime_;
+  static size_t config_size_;
+  static int64_t next_config_poll_;
+  static File upload_file_;
+  static AsyncWebServerRequest *upload_writer_;   // the one writing the file
+  static AsyncWebServerRequest *upload_request_;  // the last complete upload
+  // Set from a complete upload until its reload has renamed or removed the
+  // file. No other upload may open the file meanwhile.
+  static std::atomic<bool> upload_pending_;
+
+  static bool LoadConfig(const char *config_file, NetworkConfig &config,
+                         std::vector<WolDevice> &devices);
+  static bool BuildSnapshot(ConfigSnapshot &snapshot,
+                            const std::vector<WolDevice> &devices);
+  static bool BuildWolTargets(ConfigSnapshot &snapshot,
+                              const std::vector<WolDevice> &devices);
+  static bool BuildDeviceTable(ConfigSnapshot &snapshot,
+                               const std::vector<WolDevice> &devices);
+  static void BuildEthernetHeaders(ConfigSnapshot &snapshot);
+  static void PollConfig();
+  static bool RememberConfigFile();
+  static void HandleConfigUpload(AsyncWebServerRequest *request,
+                                 const String &filename, size_t index,
+                                 uint8_t *data, size_t len, bool final);
+  static bool TransmitWol(const WakeJob &job, size_t first, size_t count);
+  static void TransmitWolRun(const ConfigSnapshot &snapshot, size_t first,
+                             size_t count);
+  static void RewakeWol(uint32_t version, size_t index);
+  static void OnWakeRunDone();
+  static bool SetupWakeSequencer(const NetworkConfig &config,
+                                 const std::vector<WolDevice> &devices);
+  static void OnWolJobDone(const WakeJob &job);
+  static bool Authenticate(AsyncWebServerRequest *request);
+  static void RequestLogin(AsyncWebServerRequest *request);
+  static uint32_t RequestWake(const ConfigSnapshot &snapshot, uint16_t index,
+                              bool *coalesced = nullptr);
+  static bool RateLimited(AsyncWebServerRequest *request);
   static bool SetupEth();
   static bool SetupNtp();
   static void OnEthEvent(WiFiEvent_t event);
   static void SetupWebServer();
+  static void SetupApi();
+  static void PublishStatus();
+  static void FillLiveStatus(LiveStatus &status);
+  static void FormatDeviceMac(uint16_t index, char *buf);
+  static size_t FormatDeviceMetric(size_t index, char *buf, size_t size);
+  static void SendDeviceList(AsyncWebServerRequest *request);
+  static void SendApiError(AsyncWebServerRequest *request, int code,
+                           const char *error);
+  static void SendAsset(AsyncWebServerRequest *request, const WebAsset &asset,
+                        int code = 200);
   static void SetupOta();
-  static String GetRelativeUptime(const DateTimeType &type = all);
-  static String HTMLProcessor(const String &var);
+  static size_t HTMLProbeState(size_t index, char *buf, size_t size);
+  static void SendIndexPage(AsyncWebServerRequest *request, uint32_t version,
+                            std::vector<bool> &&checked,
+                            const char *message_type, const char *message);
 };
 
 #endif /* SRC_NETWORKHANDLER_H_ */
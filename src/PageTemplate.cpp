@@ -0,0 +1,100 @@
+/*
+ *
+ * PageTemplate.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "PageTemplate.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+void PageTemplate::Parse(const char *text, size_t size,
+                         const char *const *names, size_t name_count) {
+  segments_.clear();
+  const char *end = text + size;
+  const char *literal = text;
+  const char *pos = text;
+  while (pos < end) {
+    const char *open =
+        static_cast<const char *>(memchr(pos, '%', end - pos));
+    if (open == nullptr) {
+      break;
+    }
+    const char *close =
+        static_cast<const char *>(memchr(open + 1, '%', end - open - 1));
+    if (close == nullptr) {
+      break;
+    }
+    size_t name = 0;
+    const size_t length = close - open - 1;
+    while (name < name_count && (strlen(names[name]) != length ||
+                                 memcmp(names[name], open + 1, length))) {
+      name++;
+    }
+    if (name == name_count) {
+      pos = open + 1;  // the closing % may open a placeholder
+      continue;
+    }
+    AddLiteral(literal, open - literal);
+    segments_.push_back({nullptr, 0, static_cast<uint8_t>(name)});
+    literal = pos = close + 1;
+  }
+  AddLiteral(literal, end - literal);
+}
+
+void PageTemplate::AddLiteral(const char *text, size_t length) {
+  if (length > 0) {
+    segments_.push_back({text, length, 0});
+  }
+}
+
+size_t PageRenderer::Read(uint8_t *buffer, size_t size) {
+  const std::vector<PageTemplate::Segment> &segments = page_.segments();
+  size_t written = 0;
+  while (written < size && segment_ < segments.size()) {
+    const PageTemplate::Segment &segment = segments[segment_];
+    const char *source;
+    size_t length;
+    if (segment.text != nullptr) {
+      source = segment.text;
+      length = segment.length;
+    } else {
+      if (offset_ == item_length_) {
+        // Current item is out, format the next one
+        size_t next = fill_(segment.placeholder, item_, item_buffer_,
+                            sizeof(item_buffer_));
+        offset_ = 0;
+        if (next == kNoItem) {
+          item_ = 0;
+          item_length_ = 0;
+          segment_++;
+        } else {
+          item_++;
+          item_length_ = std::min(next, sizeof(item_buffer_) - 1);
+        }
+        continue;
+      }
+      source = item_buffer_;
+      length = item_length_;
+    }
+    const size_t n = std::min(length - offset_, size - written);
+    memcpy(buffer + written, source + offset_, n);
+    written += n;
+    offset_ += n;
+    if (segment.text != nullptr && offset_ == length) {
+      offset_ = 0;
+      segment_++;
+    }
+  }
+  return written;
+}
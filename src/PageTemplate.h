@@ -0,0 +1,79 @@
+#ifndef SRC_PAGETEMPLATE_H_
+#define SRC_PAGETEMPLATE_H_
+
+/*
+ *
+ * PageTemplate.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+HTML template split once into literal and %PLACEHOLDER% segments. Literal
+segments point into the template text, which has to outlive the template,
+e.g. an embedded web asset. A PageRenderer streams a page straight into the
+buffer of a chunked response. Each placeholder expands into a sequence of
+items, which are formatted one at a time into a fixed buffer, so a render
+needs the same memory no matter how many items there are.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+class PageTemplate {
+ public:
+  struct Segment {
+    const char *text;  // nullptr for a placeholder
+    size_t length;
+    uint8_t placeholder;  // index into the names passed to Parse()
+  };
+
+  // Splits text at %NAME% for every NAME in names. Any other % is literal.
+  void Parse(const char *text, size_t size, const char *const *names,
+             size_t name_count);
+  const std::vector<Segment> &segments() const { return segments_; }
+
+ private:
+  void AddLiteral(const char *text, size_t length);
+
+  std::vector<Segment> segments_;
+};
+
+class PageRenderer {
+ public:
+  static const size_t kItemSize = 512;
+  static const size_t kNoItem = SIZE_MAX;
+
+  // Writes item number item of the placeholder to buf, which holds size
+  // bytes, and returns its length. Returns kNoItem after the last item.
+  typedef std::function<size_t(uint8_t placeholder, size_t item, char *buf,
+                               size_t size)>
+      FillFn;
+
+  PageRenderer(const PageTemplate &page, FillFn fill)
+      : page_(page), fill_(fill) {}
+
+  // Writes the next part of the page to buffer. Returns 0 once it is done.
+  size_t Read(uint8_t *buffer, size_t size);
+
+ private:
+  const PageTemplate &page_;
+  FillFn fill_;
+  size_t segment_ = 0;
+  size_t offset_ = 0;  // in the current literal or item
+  size_t item_ = 0;    // next item of the current placeholder
+  size_t item_length_ = 0;
+  char item_buffer_[kItemSize];
+};
+
+#endif /* SRC_PAGETEMPLATE_H_ */
@@ -0,0 +1,399 @@
+/*
+ *
+ * ProbeEngine.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "ProbeEngine.h"
+
+#include "lwip/etharp.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/ip4.h"
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/prot/icmp.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/sockets.h"
+
+// Identifies our echo requests among other ICMP traffic
+static const uint16_t kIcmpId = 0x574F;  // "WO"
+
+// Argument block for the tcpip thread ARP calls
+struct ArpCall {
+  struct tcpip_api_call_data call;
+  ip4_addr_t addr;
+  bool request;
+  bool found;
+};
+
+const uint16_t LatencyHistogram::kBounds[kBuckets - 1] = {10,  30,  60,  120,
+                                                         300, 600, 1800};
+
+std::vector<ProbeTarget> ProbeEngine::targets_;
+std::vector<ProbeEngine::DeviceState> ProbeEngine::states_;
+ProbeEngine::RewakeFn ProbeEngine::rewake_ = nullptr;
+ProbeEngine::OnlineFn ProbeEngine::online_ = nullptr;
+uint16_t ProbeEngine::backoff_min_ = 10;
+uint16_t ProbeEngine::backoff_max_ = 300;
+uint16_t ProbeEngine::timeout_ms_ = 1000;
+portMUX_TYPE ProbeEngine::mux_ = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t ProbeEngine::task_ = nullptr;
+uint32_t ProbeEngine::generation_ = 0;
+uint32_t ProbeEngine::version_ = 0;
+
+void LatencyHistogram::Record(uint32_t seconds) {
+  uint8_t bucket = 0;
+  while (bucket < kBuckets - 1 && seconds > kBounds[bucket]) {
+    bucket++;
+  }
+  counts[bucket]++;
+  last_seconds = seconds;
+}
+
+uint32_t LatencyHistogram::Total() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < kBuckets; ++i) {
+    total += counts[i];
+  }
+  return total;
+}
+
+bool ProbeEngine::Setup(const std::vector<ProbeTarget> &targets,
+                        uint32_t version, RewakeFn rewake,
+                        uint16_t backoff_min, uint16_t backoff_max,
+                        uint16_t timeout_ms) {
+  targets_ = targets;
+  version_ = version;
+  states_.assign(targets.size(), DeviceState());
+  rewake_ = rewake;
+  backoff_min_ = backoff_min;
+  backoff_max_ = backoff_max;
+  timeout_ms_ = timeout_ms;
+  return StartTask();
+}
+
+bool ProbeEngine::Reload(const std::vector<ProbeTarget> &targets,
+                         uint32_t version,
+                         const std::vector<int32_t> &previous,
+                         uint16_t backoff_min, uint16_t backoff_max,
+                         uint16_t timeout_ms) {
+  // Allocate outside the critical section, swap inside, free after it.
+  std::vector<ProbeTarget> new_targets(targets);
+  std::vector<DeviceState> new_states(targets.size(), DeviceState());
+  portENTER_CRITICAL(&mux_);
+  for (size_t i = 0; i < new_states.size(); ++i) {
+    const int32_t before = previous[i];
+    if (before >= 0 && (size_t)before < states_.size() &&
+        targets_[before].ip == new_targets[i].ip &&
+        targets_[before].type == new_targets[i].type) {
+      new_states[i] = states_[before];
+    }
+  }
+  targets_.swap(new_targets);
+  states_.swap(new_states);
+  backoff_min_ = backoff_min;
+  backoff_max_ = backoff_max;
+  timeout_ms_ = timeout_ms;
+  generation_++;
+  version_ = version;
+  portEXIT_CRITICAL(&mux_);
+  return StartTask();
+}
+
+bool ProbeEngine::StartTask() {
+  if (task_ != nullptr) {
+    return true;
+  }
+  for (const ProbeTarget &target : targets_) {
+    if (target.type != kProbeNone) {
+      return xTaskCreate(Task, "probe_engine", PROBE_ENGINE_STACK_SIZE,
+                         nullptr, PROBE_ENGINE_PRIORITY, &task_) == pdPASS;
+    }
+  }
+  return true;  // nothing to probe, no task needed
+}
+
+bool ProbeEngine::IsProbed(size_t index) {
+  portENTER_CRITICAL(&mux_);
+  const bool probed = Probed(index);
+  portEXIT_CRITICAL(&mux_);
+  return probed;
+}
+
+void ProbeEngine::OnWolSent(size_t index) {
+  const int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&mux_);
+  if (!Probed(index)) {
+    portEXIT_CRITICAL(&mux_);
+    return;
+  }
+  DeviceState &state = states_[index];
+  state.wol_sent = true;
+  if (state.state == kHostOnline) {
+    // A forced wake of a host that is up only checks it is still up, it
+    // didn't boot and must not show up in the latency histogram.
+    state.state = kHostVerifying;
+    state.next_probe = now + backoff_min_ * 1000000LL;
+  } else if (state.state != kHostWaking && state.state != kHostVerifying) {
+    // Repeated packets of an ongoing wake keep the original start time.
+    state.state = kHostWaking;
+    state.wake_time = now;
+    state.backoff = backoff_min_;
+    state.next_probe = now + backoff_min_ * 1000000LL;
+  }
+  portEXIT_CRITICAL(&mux_);
+}
+
+void ProbeEngine::Verify(size_t index) {
+  portENTER_CRITICAL(&mux_);
+  if (Probed(index) && states_[index].state == kHostOnline) {
+    states_[index].state = kHostVerifying;
+    states_[index].next_probe = 0;
+  }
+  portEXIT_CRITICAL(&mux_);
+}
+
+bool ProbeEngine::IsOnline(size_t index) {
+  const HostState state = State(index);
+  return state == kHostOnline || state == kHostVerifying;
+}
+
+HostState ProbeEngine::State(size_t index) {
+  portENTER_CRITICAL(&mux_);
+  const HostState state = Probed(index) ? states_[index].state : kHostUnknown;
+  portEXIT_CRITICAL(&mux_);
+  return state;
+}
+
+uint32_t ProbeEngine::WolAnswers(size_t index) {
+  portENTER_CRITICAL(&mux_);
+  const uint32_t answers = Probed(index) ? states_[index].wol_answers : 0;
+  portEXIT_CRITICAL(&mux_);
+  return answers;
+}
+
+LatencyHistogram ProbeEngine::Histogram(size_t index) {
+  LatencyHistogram histogram = LatencyHistogram();
+  portENTER_CRITICAL(&mux_);
+  if (Probed(index)) {
+    histogram = states_[index].histogram;
+  }
+  portEXIT_CRITICAL(&mux_);
+  return histogram;
+}
+
+void ProbeEngine::FormatState(size_t index, char *buf, size_t len) {
+  switch (State(index)) {
+    case kHostWaking:
+      snprintf(buf, len, "waking");
+      break;
+    case kHostVerifying:
+    case kHostOnline:
+      if (Histogram(index).Total()) {
+        snprintf(buf, len, "up %us", Histogram(index).last_seconds);
+      } else {
+        snprintf(buf, len, "up");
+      }
+      break;
+    default:
+      snprintf(buf, len, IsProbed(index) ? "down" : "");
+  }
+}
+
+void ProbeEngine::Task(void *parameter) {
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(PROBE_ENGINE_POLL_MS));
+    // The targets can be swapped by a reload at any time, so they are only
+    // accessed under the mux and a result is dropped if the generation
+    // changed while probing.
+    for (size_t i = 0;; ++i) {
+      portENTER_CRITICAL(&mux_);
+      if (i >= targets_.size()) {
+        portEXIT_CRITICAL(&mux_);
+        break;
+      }
+      const ProbeTarget target = targets_[i];
+      const uint32_t generation = generation_;
+      const HostState before = states_[i].state;
+      const bool due = target.type != kProbeNone &&
+                       (before == kHostWaking || before == kHostVerifying) &&
+                       esp_timer_get_time() >= states_[i].next_probe;
+      portEXIT_CRITICAL(&mux_);
+      if (!due) {
+        continue;
+      }
+
+      const bool online = Probe(target);
+      const int64_t now = esp_timer_get_time();
+      bool rewake = false;
+      bool woke = false;
+      uint32_t version = 0;
+      uint32_t seconds = 0;
+      portENTER_CRITICAL(&mux_);
+      if (generation != generation_) {
+        portEXIT_CRITICAL(&mux_);
+        break;
+      }
+      DeviceState &state = states_[i];
+      if (online) {
+        if (state.state == kHostWaking) {
+          seconds = (now - state.wake_time) / 1000000;
+          state.histogram.Record(seconds);
+          woke = true;
+        }
+        if (state.wol_sent) {
+          state.wol_answers++;
+          state.wol_sent = false;
+        }
+        state.state = kHostOnline;
+      } else if (state.state == kHostVerifying) {
+        state.state = kHostUnknown;  // went down since the last check
+        rewake = true;
+      } else {
+        state.backoff = state.backoff * 2 < backoff_max_ ? state.backoff * 2
+                                                         : backoff_max_;
+        state.next_probe = now + state.backoff * 1000000LL;
+        rewake = true;
+      }
+      version = version_;
+      portEXIT_CRITICAL(&mux_);
+      // A reload after this publishes a new version, which drops the wake.
+      if (rewake) {
+        rewake_(version, i);
+      }
+      if (woke && online_ != nullptr) {
+        online_(i, seconds);
+      }
+    }
+  }
+}
+
+bool ProbeEngine::Probe(const ProbeTarget &target) {
+  switch (target.type) {
+    case kProbeIcmp:
+      return ProbeIcmp(target.ip);
+    case kProbeArp:
+      return ProbeArp(target.ip);
+    case kProbeTcp:
+      return ProbeTcp(target.ip, target.tcp_port);
+    default:
+      return false;
+  }
+}
+
+bool ProbeEngine::ProbeIcmp(uint32_t ip) {
+  static uint16_t seqno = 0;
+  int sock = socket(AF_INET, SOCK_RAW, IP_PROTO_ICMP);
+  if (sock < 0) {
+    return false;
+  }
+  struct timeval timeout = {timeout_ms_ / 1000, (timeout_ms_ % 1000) * 1000};
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  struct icmp_echo_hdr request;
+  ICMPH_TYPE_SET(&request, ICMP_ECHO);
+  ICMPH_CODE_SET(&request, 0);
+  request.id = htons(kIcmpId);
+  request.seqno = htons(++seqno);
+  request.chksum = 0;
+  request.chksum = inet_chksum(&request, sizeof(request));
+
+  struct sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_addr.s_addr = ip;
+  bool online = false;
+  if (sendto(sock, &request, sizeof(request), 0, (struct sockaddr *)&to,
+             sizeof(to)) > 0) {
+    const int64_t deadline = esp_timer_get_time() + timeout_ms_ * 1000LL;
+    uint8_t reply[64];
+    struct sockaddr_in from;
+    socklen_t from_len = sizeof(from);
+    // Skip replies to other requests until ours arrives or time runs out.
+    while (!online && esp_timer_get_time() < deadline) {
+      int len = recvfrom(sock, reply, sizeof(reply), 0,
+                         (struct sockaddr *)&from, &from_len);
+      if (len <= 0) {
+        break;
+      }
+      const size_t ip_len = IPH_HL_BYTES((struct ip_hdr *)reply);
+      if (len < (int)(ip_len + sizeof(icmp_echo_hdr))) {
+        continue;
+      }
+      const icmp_echo_hdr *echo = (const icmp_echo_hdr *)(reply + ip_len);
+      online = from.sin_addr.s_addr == ip && ICMPH_TYPE(echo) == ICMP_ER &&
+               echo->id == request.id && echo->seqno == request.seqno;
+    }
+  }
+  close(sock);
+  return online;
+}
+
+static err_t ArpInTcpip(struct tcpip_api_call_data *call) {
+  ArpCall *arp = (ArpCall *)call;
+  struct netif *netif = ip4_route(&arp->addr);
+  if (netif == nullptr) {
+    return ERR_RTE;
+  }
+  if (arp->request) {
+    etharp_request(netif, &arp->addr);
+  } else {
+    struct eth_addr *eth_ret;
+    const ip4_addr_t *ip_ret;
+    arp->found = etharp_find_addr(netif, &arp->addr, &eth_ret, &ip_ret) >= 0;
+  }
+  return ERR_OK;
+}
+
+// Only works for devices on a local segment. A cache entry from before the
+// device went to sleep can make it look online until it expires.
+bool ProbeEngine::ProbeArp(uint32_t ip) {
+  ArpCall arp;
+  ip4_addr_set_u32(&arp.addr, ip);
+  arp.request = true;
+  arp.found = false;
+  if (tcpip_api_call(ArpInTcpip, &arp.call) != ERR_OK) {
+    return false;
+  }
+  vTaskDelay(pdMS_TO_TICKS(timeout_ms_));
+  arp.request = false;
+  tcpip_api_call(ArpInTcpip, &arp.call);
+  return arp.found;
+}
+
+bool ProbeEngine::ProbeTcp(uint32_t ip, uint16_t port) {
+  int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (sock < 0) {
+    return false;
+  }
+  fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+  struct sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(port);
+  to.sin_addr.s_addr = ip;
+  bool online = false;
+  if (connect(sock, (struct sockaddr *)&to, sizeof(to)) == 0) {
+    online = true;
+  } else if (errno == EINPROGRESS) {
+    fd_set writable;
+    FD_ZERO(&writable);
+    FD_SET(sock, &writable);
+    struct timeval timeout = {timeout_ms_ / 1000,
+                              (timeout_ms_ % 1000) * 1000};
+    if (select(sock + 1, nullptr, &writable, nullptr, &timeout) > 0) {
+      int error = 0;
+      socklen_t error_len = sizeof(error);
+      getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &error_len);
+      online = error == 0;
+    }
+  }
+  close(sock);
+  return online;
+}
@@ -0,0 +1,131 @@
+#ifndef SRC_PROBEENGINE_H_
+#define SRC_PROBEENGINE_H_
+
+/*
+ *
+ * ProbeEngine.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Checks whether woken devices came back online. After a WOL packet went out,
+the device is probed with ICMP echo, an ARP request or a TCP connect from a
+background task. Devices that answer are marked online and their
+wake-to-online latency is recorded, devices that don't are woken again with
+exponential backoff.
+*/
+
+#include <Arduino.h>
+
+#include <vector>
+
+#define PROBE_ENGINE_STACK_SIZE 4096
+#define PROBE_ENGINE_PRIORITY 1
+#define PROBE_ENGINE_POLL_MS 250
+
+enum ProbeType : uint8_t { kProbeNone, kProbeIcmp, kProbeArp, kProbeTcp };
+
+enum HostState : uint8_t {
+  kHostUnknown,    // not probed yet, or the last probe failed
+  kHostWaking,     // WOL sent, waiting for the device to answer
+  kHostVerifying,  // was online, checking it still is
+  kHostOnline
+};
+
+// How to reach a device for probing
+struct ProbeTarget {
+  uint32_t ip;
+  uint16_t tcp_port;
+  ProbeType type;
+};
+
+// Fixed bucket histogram of wake-to-online latencies
+struct LatencyHistogram {
+  static const uint8_t kBuckets = 8;
+  // Upper bounds in seconds, the last bucket takes everything above
+  static const uint16_t kBounds[kBuckets - 1];
+
+  uint32_t counts[kBuckets];
+  uint32_t last_seconds;
+
+  void Record(uint32_t seconds);
+  uint32_t Total() const;
+};
+
+class ProbeEngine {
+ public:
+  // Gets the config version of the targets, the index refers to its devices
+  typedef void (*RewakeFn)(uint32_t version, size_t index);
+  // Called from the probe task when a woken device answers
+  typedef void (*OnlineFn)(size_t index, uint32_t seconds);
+
+  static bool Setup(const std::vector<ProbeTarget> &targets, uint32_t version,
+                    RewakeFn rewake, uint16_t backoff_min,
+                    uint16_t backoff_max, uint16_t timeout_ms);
+  // Replaces the targets after a config reload. previous[i] is the index
+  // device i had before, or -1 for a new device, so states and histograms of
+  // unchanged devices are kept.
+  static bool Reload(const std::vector<ProbeTarget> &targets,
+                     uint32_t version, const std::vector<int32_t> &previous,
+                     uint16_t backoff_min, uint16_t backoff_max,
+                     uint16_t timeout_ms);
+  static void SetOnlineCallback(OnlineFn online) { online_ = online; }
+  // Called for every WOL packet sent to the device at index
+  static void OnWolSent(size_t index);
+  // Schedules a probe of an online device instead of waking it again
+  static void Verify(size_t index);
+  static bool IsProbed(size_t index);
+  static bool IsOnline(size_t index);
+  static HostState State(size_t index);
+  // Counts the probe answers that came after a WOL packet, it only changes
+  // once the device answered a wake. Unlike IsOnline(), it tells a device
+  // that answered a new wake from one that was up before.
+  static uint32_t WolAnswers(size_t index);
+  static LatencyHistogram Histogram(size_t index);
+  // Writes a short state text like "up 42s" or "waking" to buf
+  static void FormatState(size_t index, char *buf, size_t len);
+
+ private:
+  struct DeviceState {
+    HostState state;
+    int64_t wake_time;   // us, when the first WOL of this wake went out
+    int64_t next_probe;  // us
+    uint32_t backoff;    // s
+    uint32_t wol_answers;
+    bool wol_sent;  // since the last answer
+    LatencyHistogram histogram;
+  };
+
+  // Only valid while holding mux_
+  static bool Probed(size_t index) {
+    return index < targets_.size() && targets_[index].type != kProbeNone;
+  }
+  static bool StartTask();
+  static void Task(void *parameter);
+  static bool Probe(const ProbeTarget &target);
+  static bool ProbeIcmp(uint32_t ip);
+  static bool ProbeArp(uint32_t ip);
+  static bool ProbeTcp(uint32_t ip, uint16_t port);
+
+  static std::vector<ProbeTarget> targets_;
+  static std::vector<DeviceState> states_;
+  static RewakeFn rewake_;
+  static OnlineFn online_;
+  static uint16_t backoff_min_;
+  static uint16_t backoff_max_;
+  static uint16_t timeout_ms_;
+  static portMUX_TYPE mux_;
+  static TaskHandle_t task_;
+  static uint32_t generation_;  // incremented by every reload
+  static uint32_t version_;     // of the config the targets belong to
+};
+
+#endif  // SRC_PROBEENGINE_H_
@@ -0,0 +1,57 @@
+/*
+ *
+ * RateLimiter.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "RateLimiter.h"
+
+static const uint64_t kTokenUnit = 1000000;
+
+void RateLimiter::Setup(uint16_t rate, uint16_t burst) {
+  portENTER_CRITICAL(&mux_);
+  rate_ = rate;
+  bucket_size_ = burst * kTokenUnit;
+  for (Bucket &bucket : buckets_) {
+    bucket.last_refill = 0;
+  }
+  portEXIT_CRITICAL(&mux_);
+}
+
+bool RateLimiter::Allow(uint32_t source) {
+  const int64_t now = esp_timer_get_time();
+  portENTER_CRITICAL(&mux_);
+  Bucket *bucket = &buckets_[0];
+  for (Bucket &candidate : buckets_) {
+    if (candidate.last_refill != 0 && candidate.source == source) {
+      bucket = &candidate;
+      break;
+    }
+    if (candidate.last_refill < bucket->last_refill) {
+      bucket = &candidate;
+    }
+  }
+  if (bucket->last_refill == 0 || bucket->source != source) {
+    bucket->source = source;
+    bucket->tokens = bucket_size_;
+  } else {
+    const uint64_t tokens =
+        bucket->tokens + (uint64_t)(now - bucket->last_refill) * rate_;
+    bucket->tokens = tokens > bucket_size_ ? bucket_size_ : tokens;
+  }
+  bucket->last_refill = now;
+  const bool allowed = bucket->tokens >= kTokenUnit;
+  if (allowed) {
+    bucket->tokens -= kTokenUnit;
+  }
+  portEXIT_CRITICAL(&mux_);
+  return allowed;
+}
@@ -0,0 +1,49 @@
+#ifndef SRC_RATELIMITER_H_
+#define SRC_RATELIMITER_H_
+
+/*
+ *
+ * RateLimiter.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Token bucket per source IPv4 address. The buckets of the most recently seen
+sources are kept in a fixed table, a new source takes over the bucket used
+longest ago and starts with a full one. Tokens are kept in millionths, like
+those of the wake engine.
+*/
+
+#include <Arduino.h>
+
+#define RATE_LIMITER_SOURCES 16
+
+class RateLimiter {
+ public:
+  // Allows rate requests per second per source, and up to burst at once.
+  void Setup(uint16_t rate, uint16_t burst);
+  // Takes a token from the bucket of source. Returns false if it is empty.
+  bool Allow(uint32_t source);
+
+ private:
+  struct Bucket {
+    uint32_t source;
+    uint64_t tokens;
+    int64_t last_refill;  // 0 for an unused bucket
+  };
+
+  uint32_t rate_ = 1;
+  uint64_t bucket_size_ = 0;
+  Bucket buckets_[RATE_LIMITER_SOURCES] = {};
+  portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+};
+
+#endif /* SRC_RATELIMITER_H_ */
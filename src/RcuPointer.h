@@ -0,0 +1,96 @@
+#ifndef SRC_RCUPOINTER_H_
+#define SRC_RCUPOINTER_H_
+
+/*
+ *
+ * RcuPointer.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Pointer to an immutable object that can be replaced while other tasks read
+it, in the style of read-copy-update. Readers never block or take a lock, a
+ReadGuard only counts the reader in one of two counters while it holds the
+object. Publish() swaps in the new object, then flips the counter new
+readers use and waits for the old one to drain, twice. After that no reader
+can still hold the previous object and it is deleted.
+Publish() blocks until then, so it must not be called while holding a
+ReadGuard, and only from one task at a time.
+*/
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#define RCU_POINTER_WAIT_MS 1
+
+template <typename T>
+class RcuPointer {
+ public:
+  class ReadGuard {
+   public:
+    ReadGuard(ReadGuard &&other)
+        : counter_(other.counter_), object_(other.object_) {
+      other.counter_ = nullptr;
+    }
+    ReadGuard(const ReadGuard &) = delete;
+    ReadGuard &operator=(const ReadGuard &) = delete;
+    ~ReadGuard() {
+      if (counter_ != nullptr) {
+        counter_->fetch_sub(1);
+      }
+    }
+
+    const T *get() const { return object_; }
+    const T *operator->() const { return object_; }
+    const T &operator*() const { return *object_; }
+    explicit operator bool() const { return object_ != nullptr; }
+
+   private:
+    friend class RcuPointer;
+    ReadGuard(std::atomic<uint32_t> *counter, const T *object)
+        : counter_(counter), object_(object) {}
+
+    std::atomic<uint32_t> *counter_;
+    const T *object_;
+  };
+
+  RcuPointer() : current_(nullptr), epoch_(0), readers_{{0}, {0}} {}
+  ~RcuPointer() { delete current_.load(); }
+
+  // The object is loaded after the reader is counted, so Publish() either
+  // waits for this reader or this reader gets the new object.
+  ReadGuard Read() const {
+    std::atomic<uint32_t> *counter = &readers_[epoch_.load() & 1];
+    counter->fetch_add(1);
+    return ReadGuard(counter, current_.load());
+  }
+
+  void Publish(T *next) {
+    T *previous = current_.exchange(next);
+    // A reader may have picked its counter just before a flip, but counted
+    // itself after the wait. Draining both counters catches it.
+    for (uint8_t phase = 0; phase < 2; ++phase) {
+      const uint32_t draining = epoch_.fetch_add(1) & 1;
+      while (readers_[draining].load() != 0) {
+        delay(RCU_POINTER_WAIT_MS);
+      }
+    }
+    delete previous;
+  }
+
+ private:
+  std::atomic<T *> current_;
+  std::atomic<uint32_t> epoch_;
+  mutable std::atomic<uint32_t> readers_[2];
+};
+
+#endif /* SRC_RCUPOINTER_H_ */
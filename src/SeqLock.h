@@ -0,0 +1,71 @@
+#ifndef SRC_SEQLOCK_H_
+#define SRC_SEQLOCK_H_
+
+/*
+ *
+ * SeqLock.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Value of a plain struct written by one task and copied out by any number of
+others, guarded by a sequence counter. The counter is odd while Write() is
+copying a new value in. Read() copies the value and starts over if the
+counter was odd or moved meanwhile, so readers never take a lock and never
+slow down the writer. A reader that keeps losing against the writer sleeps
+a tick between tries, the writer may be a lower priority task on its core.
+Write() must only ever be called from one task.
+*/
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#define SEQ_LOCK_WAIT_MS 1
+
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock values are copied with memcpy");
+
+ public:
+  SeqLock() : sequence_(0), value_() {}
+
+  void Write(const T &value) {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&value_, &value, sizeof(T));
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  void Read(T &value) const {
+    for (;;) {
+      const uint32_t before = sequence_.load(std::memory_order_acquire);
+      if ((before & 1) == 0) {
+        memcpy(&value, &value_, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == before) {
+          return;
+        }
+      }
+      delay(SEQ_LOCK_WAIT_MS);
+    }
+  }
+
+ private:
+  std::atomic<uint32_t> sequence_;
+  T value_;
+};
+
+#endif /* SRC_SEQLOCK_H_ */
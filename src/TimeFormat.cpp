@@ -0,0 +1,148 @@
+/*
+ *
+ * TimeFormat.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "TimeFormat.h"
+
+namespace {
+
+// Appends to a buffer, and empties it in Finish() if anything didn't fit
+class Writer {
+ public:
+  Writer(char *buf, size_t size)
+      : buf_(buf), size_(size), length_(0), overflow_(false) {}
+
+  void Char(char c) {
+    if (length_ + 1 < size_) {
+      buf_[length_++] = c;
+    } else {
+      overflow_ = true;
+    }
+  }
+
+  void Text(const char *text) {
+    while (*text != '\0') {
+      Char(*text++);
+    }
+  }
+
+  // Writes value with at least digits digits, padded with zeros
+  void Number(uint32_t value, uint8_t digits = 1) {
+    char reversed[10];
+    uint8_t count = 0;
+    do {
+      reversed[count++] = '0' + value % 10;
+      value /= 10;
+    } while (value != 0);
+    for (; count < digits; --digits) {
+      Char('0');
+    }
+    while (count > 0) {
+      Char(reversed[--count]);
+    }
+  }
+
+  size_t Finish() {
+    if (overflow_) {
+      length_ = 0;
+    }
+    if (size_ > 0) {
+      buf_[length_] = '\0';
+    }
+    return length_;
+  }
+
+ private:
+  char *buf_;
+  size_t size_;
+  size_t length_;
+  bool overflow_;
+};
+
+}  // namespace
+
+size_t TimeFormat::DateTime(const tm &ti, DateTimeType type, char *buf,
+                            size_t size) {
+  Writer out(buf, size);
+  if (type != time_only) {
+    out.Number(ti.tm_year + 1900, 4);
+    out.Char('-');
+    out.Number(ti.tm_mon + 1, 2);
+    out.Char('-');
+    out.Number(ti.tm_mday, 2);
+  }
+  if (type == all) {
+    out.Char(' ');
+  }
+  if (type != date_only) {
+    out.Number(ti.tm_hour, 2);
+    out.Char(':');
+    out.Number(ti.tm_min, 2);
+    out.Char(':');
+    out.Number(ti.tm_sec, 2);
+  }
+  return out.Finish();
+}
+
+size_t TimeFormat::Duration(uint32_t seconds, const char *prefix,
+                            const char *suffix, DateTimeType type, char *buf,
+                            size_t size) {
+  // A word is either text or a number with its unit
+  struct Word {
+    const char *text;
+    uint32_t value;
+    char unit;
+  };
+  Word words[6];
+  size_t count = 0;
+  if (prefix[0] != '\0') {
+    words[count++] = {prefix, 0, '\0'};
+  }
+  const uint32_t days = seconds / (24 * 3600);
+  const uint32_t hours = seconds / 3600 % 24;
+  const uint32_t minutes = seconds / 60 % 60;
+  if (days != 0) {
+    words[count++] = {nullptr, days, 'd'};
+  }
+  if (hours != 0) {
+    words[count++] = {nullptr, hours, 'h'};
+  }
+  if (minutes != 0) {
+    words[count++] = {nullptr, minutes, 'm'};
+  }
+  words[count++] = {nullptr, seconds % 60, 's'};
+  if (suffix[0] != '\0') {
+    words[count++] = {suffix, 0, '\0'};
+  }
+
+  size_t first = 0;
+  size_t last = count;
+  if (type == date_only) {
+    last = count < 2 ? count : 2;
+  } else if (type == time_only) {
+    first = 2;
+  }
+  Writer out(buf, size);
+  for (size_t i = first; i < last; ++i) {
+    if (i != first) {
+      out.Char(' ');
+    }
+    if (words[i].text != nullptr) {
+      out.Text(words[i].text);
+    } else {
+      out.Number(words[i].value);
+      out.Char(words[i].unit);
+    }
+  }
+  return out.Finish();
+}
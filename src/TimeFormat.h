@@ -0,0 +1,52 @@
+#ifndef SRC_TIMEFORMAT_H_
+#define SRC_TIMEFORMAT_H_
+
+/*
+ *
+ * TimeFormat.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Dates, times and durations as shown on the display and the web interface,
+written into buffers of the caller. Numbers are converted digit by digit,
+nothing here allocates or goes through printf. Text that doesn't fit the
+buffer is not cut off, the buffer is left empty instead.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ctime>
+
+enum DateTimeType { all, date_only, time_only };
+
+class TimeFormat {
+ public:
+  // "YYYY-MM-DD HH:MM:SS"
+  static const size_t kDateTimeSize = 20;
+  // "49709d 23h 59m 59s ago", the longest with a prefix or suffix
+  static const size_t kDurationSize = 24;
+
+  // Writes ti like strftime() with "%F %H:%M:%S", "%F" or "%H:%M:%S".
+  // Returns the length written.
+  static size_t DateTime(const tm &ti, DateTimeType type, char *buf,
+                         size_t size);
+  // Writes seconds as words like "3d 4h 5m 6s" between prefix and suffix,
+  // which may be empty. Days, hours and minutes are left out while 0. The
+  // date is the first two words and the time the remaining ones, to fill the
+  // two lines of the display. Returns the length written.
+  static size_t Duration(uint32_t seconds, const char *prefix,
+                         const char *suffix, DateTimeType type, char *buf,
+                         size_t size);
+};
+
+#endif /* SRC_TIMEFORMAT_H_ */
@@ -0,0 +1,151 @@
+/*
+ *
+ * UdpBurstSender.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "UdpBurstSender.h"
+
+#include "Metrics.h"
+#include "NetworkHandler.h"
+#include "lwip/pbuf.h"
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/udp.h"
+
+// Argument block for the tcpip thread call. The lwIP call data has to be
+// the first member.
+struct BurstCall {
+  struct tcpip_api_call_data call;
+  const WolTarget *targets;
+  size_t target_count;
+  uint32_t generation;
+  size_t first;
+  size_t count;
+  bool pooled;
+};
+
+const WolTarget *UdpBurstSender::targets_ = nullptr;
+size_t UdpBurstSender::target_count_ = 0;
+uint32_t UdpBurstSender::generation_ = 0;
+udp_pcb *UdpBurstSender::pcb_ = nullptr;
+std::vector<pbuf *> UdpBurstSender::pool_;
+UdpBurstSender::Stats UdpBurstSender::stats_ = {0, 0, 0, 0, 0, UINT32_MAX};
+int64_t UdpBurstSender::window_start_ = 0;
+uint32_t UdpBurstSender::window_packets_ = 0;
+
+bool UdpBurstSender::SendBurst(const WolTarget *targets, size_t target_count,
+                               uint32_t generation, size_t first,
+                               size_t count) {
+  if (targets == nullptr || first + count > target_count) {
+    return false;
+  }
+  BurstCall burst;
+  burst.targets = targets;
+  burst.target_count = target_count;
+  burst.generation = generation;
+  burst.first = first;
+  burst.count = count;
+  burst.pooled = false;
+  tcpip_api_call(SendBurstInTcpip, (struct tcpip_api_call_data *)&burst);
+  return burst.pooled;
+}
+
+// Runs in the tcpip thread
+err_t UdpBurstSender::SendBurstInTcpip(tcpip_api_call_data *call) {
+  BurstCall *burst = (BurstCall *)call;
+  if (!pool_.empty() && burst->generation != generation_) {
+    FreePool();  // points at the targets of an old config
+  }
+  if (pool_.empty()) {
+    targets_ = burst->targets;
+    target_count_ = burst->target_count;
+    generation_ = burst->generation;
+    if (!BuildPool()) {
+      return ERR_MEM;
+    }
+  }
+  burst->pooled = true;
+
+  uint32_t sent = 0;
+  const uint32_t heap_before = ESP.getFreeHeap();
+  for (size_t i = burst->first; i < burst->first + burst->count; ++i) {
+    if (targets_[i].transport != kTransportUdp) {
+      continue;
+    }
+    ip_addr_t addr;
+    IP_SET_TYPE_VAL(addr, IPADDR_TYPE_V4);
+    ip4_addr_set_u32(ip_2_ip4(&addr), targets_[i].ip);
+    // udp_sendto() chains its own header pbuf in front of the PBUF_REF and
+    // releases it again, so the payload is never copied and the pool pbuf
+    // stays ours.
+    if (udp_sendto(pcb_, pool_[i], &addr, targets_[i].port) == ERR_OK) {
+      sent++;
+    } else {
+      stats_.failures++;
+      Metrics::udp_failures.Add();
+    }
+  }
+  const uint32_t heap_after = ESP.getFreeHeap();
+
+  stats_.bursts++;
+  stats_.packets += sent;
+  stats_.heap_delta = (int32_t)heap_before - (int32_t)heap_after;
+  if (heap_after < stats_.heap_lowest) {
+    stats_.heap_lowest = heap_after;
+  }
+  UpdateRate(sent);
+  return ERR_OK;
+}
+
+// Runs in the tcpip thread
+bool UdpBurstSender::BuildPool() {
+  pcb_ = udp_new();
+  if (pcb_ == nullptr) {
+    return false;
+  }
+  ip_set_option(pcb_, SOF_BROADCAST);
+
+  pool_.reserve(target_count_);
+  for (size_t i = 0; i < target_count_; ++i) {
+    pbuf *p =
+        pbuf_alloc(PBUF_TRANSPORT, targets_[i].payload_size(), PBUF_REF);
+    if (p == nullptr) {
+      FreePool();
+      return false;
+    }
+    p->payload = (void *)targets_[i].payload();
+    pool_.push_back(p);
+  }
+  return true;
+}
+
+// Runs in the tcpip thread
+void UdpBurstSender::FreePool() {
+  for (pbuf *allocated : pool_) {
+    pbuf_free(allocated);
+  }
+  pool_.clear();
+  if (pcb_ != nullptr) {
+    udp_remove(pcb_);
+    pcb_ = nullptr;
+  }
+}
+
+void UdpBurstSender::UpdateRate(uint32_t sent) {
+  const int64_t now = esp_timer_get_time();
+  if (now - window_start_ >= 1000000) {
+    // A window without any bursts in between means the rate dropped to 0.
+    stats_.packets_per_sec = now - window_start_ < 2000000 ? window_packets_ : 0;
+    window_start_ = now;
+    window_packets_ = 0;
+  }
+  window_packets_ += sent;
+}
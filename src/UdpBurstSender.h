@@ -0,0 +1,71 @@
+#ifndef SRC_UDPBURSTSENDER_H_
+#define SRC_UDPBURSTSENDER_H_
+
+/*
+ *
+ * UdpBurstSender.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Zero-copy UDP sender for the prebuilt WOL targets. Every target gets a
+PBUF_REF pbuf pointing at its magic packet, and a whole burst is sent with
+udp_sendto() from a single call into the tcpip thread.
+*/
+
+#include <Arduino.h>
+
+#include <vector>
+
+#include "lwip/err.h"
+
+struct tcpip_api_call_data;
+struct udp_pcb;
+struct pbuf;
+struct WolTarget;
+
+class UdpBurstSender {
+ public:
+  struct Stats {
+    uint32_t packets;          // packets sent since boot
+    uint32_t failures;         // failed udp_sendto() calls
+    uint32_t bursts;           // calls into the tcpip thread
+    uint32_t packets_per_sec;  // packets sent in the last full second
+    int32_t heap_delta;        // free heap lost by the last burst
+    uint32_t heap_lowest;      // lowest free heap seen after a burst
+  };
+
+  // Sends targets[first] to targets[first + count - 1]. The pbuf pool is
+  // built lazily in the tcpip thread, which doesn't exist before ETH.begin(),
+  // and rebuilt whenever generation changes. The caller keeps targets alive
+  // until the call returns. Returns false if the pbuf pool isn't available
+  // and nothing was sent.
+  static bool SendBurst(const WolTarget *targets, size_t target_count,
+                        uint32_t generation, size_t first, size_t count);
+  static const Stats &GetStats() { return stats_; }
+
+ private:
+  static err_t SendBurstInTcpip(tcpip_api_call_data *call);
+  static bool BuildPool();
+  static void FreePool();
+  static void UpdateRate(uint32_t sent);
+
+  static const WolTarget *targets_;
+  static size_t target_count_;
+  static uint32_t generation_;  // of the targets the pool points at
+  static udp_pcb *pcb_;
+  static std::vector<pbuf *> pool_;
+  static Stats stats_;
+  static int64_t window_start_;
+  static uint32_t window_packets_;
+};
+
+#endif  // SRC_UDPBURSTSENDER_H_
@@ -0,0 +1,45 @@
+/*
+ *
+ * WakeCoalescer.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "WakeCoalescer.h"
+
+bool WakeCoalescer::Claim(size_t index, uint32_t now_ms, uint32_t window_ms,
+                          uint32_t &job) {
+  std::atomic<uint64_t> &wake = wakes_[index];
+  // 0 marks a device never claimed, millis() is 0 only right after boot.
+  if (now_ms == 0) {
+    now_ms = 1;
+  }
+  // A new claim has no job yet, it is set along with the time.
+  uint64_t current = wake;
+  for (;;) {
+    const uint32_t claimed = current >> 32;
+    if (claimed != 0 && now_ms - claimed < window_ms) {
+      job = current;
+      return false;
+    }
+    if (wake.compare_exchange_weak(current, (uint64_t)now_ms << 32)) {
+      return true;
+    }
+  }
+}
+
+void WakeCoalescer::SetJob(size_t index, uint32_t job) {
+  std::atomic<uint64_t> &wake = wakes_[index];
+  uint64_t current = wake;
+  // Without a job the claim is released, so the next request tries again.
+  while (!wake.compare_exchange_weak(
+      current, job == 0 ? 0 : (current & 0xFFFFFFFF00000000ULL) | job)) {
+  }
+}
@@ -0,0 +1,51 @@
+#ifndef SRC_WAKECOALESCER_H_
+#define SRC_WAKECOALESCER_H_
+
+/*
+ *
+ * WakeCoalescer.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Joins wake requests for the same device that arrive within a quiet window.
+The first request claims the device and queues a wake job, later ones get
+that job back instead of sending packets of their own. Each device is one
+compare-and-swap on its request time and job, so concurrent requests from
+the web server and the Arduino loop never send the same device twice, nor
+get the job of an earlier claim back. There is one coalescer per device
+table, indexed like it.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+class WakeCoalescer {
+ public:
+  explicit WakeCoalescer(size_t devices) : wakes_(devices) {}
+
+  // Claims a wake of the device at index at now_ms. Returns false if a wake
+  // was claimed less than window_ms before, job then holds its job id, or 0
+  // if it isn't queued yet.
+  bool Claim(size_t index, uint32_t now_ms, uint32_t window_ms,
+             uint32_t &job);
+  // Records the job queued for a claim, or releases the claim if job is 0.
+  void SetJob(size_t index, uint32_t job);
+
+ private:
+  // The claim time in ms in the upper half, 0 if never, the job below
+  std::vector<std::atomic<uint64_t>> wakes_;
+};
+
+#endif /* SRC_WAKECOALESCER_H_ */
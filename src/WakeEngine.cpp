@@ -0,0 +1,147 @@
+/*
+ *
+ * WakeEngine.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "WakeEngine.h"
+
+#include <algorithm>
+
+// Tokens are kept in millionths, so one second of refill at `rate_` packets
+// per second adds exactly rate_ * kTokenUnit.
+static const uint64_t kTokenUnit = 1000000;
+
+WakeEngine::SendFn WakeEngine::send_ = nullptr;
+WakeEngine::JobDoneFn WakeEngine::done_ = nullptr;
+QueueHandle_t WakeEngine::queue_ = nullptr;
+uint32_t WakeEngine::rate_ = 1;
+uint64_t WakeEngine::bucket_size_ = kTokenUnit;
+uint64_t WakeEngine::tokens_ = 0;
+int64_t WakeEngine::last_refill_ = 0;
+std::atomic<uint32_t> WakeEngine::next_job_id_(1);
+std::atomic<uint32_t> WakeEngine::pending_packets_(0);
+std::atomic<uint32_t> WakeEngine::completed_jobs_(0);
+std::atomic<uint32_t> WakeEngine::last_completed_job_(0);
+
+bool WakeEngine::Setup(SendFn send, JobDoneFn done, uint16_t rate,
+                       uint16_t burst) {
+  if (queue_ != nullptr) {
+    return true;  // already running
+  }
+  send_ = send;
+  done_ = done;
+  rate_ = rate;
+  bucket_size_ = burst * kTokenUnit;
+  tokens_ = bucket_size_;
+  last_refill_ = esp_timer_get_time();
+
+  queue_ = xQueueCreate(WAKE_ENGINE_QUEUE_LENGTH, sizeof(WakeJob));
+  if (queue_ == nullptr) {
+    return false;
+  }
+  if (xTaskCreate(Task, "wake_engine", WAKE_ENGINE_STACK_SIZE, nullptr,
+                  WAKE_ENGINE_PRIORITY, nullptr) != pdPASS) {
+    vQueueDelete(queue_);
+    queue_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+uint32_t WakeEngine::Enqueue(uint32_t version, uint16_t first, uint16_t count,
+                             bool force, bool periodic) {
+  const uint32_t id = TryEnqueue(version, first, count, force, periodic);
+  if (id == 0 && queue_ != nullptr && count != 0) {
+    Serial.println("WOL queue full, wake request dropped.");
+  }
+  return id;
+}
+
+uint32_t WakeEngine::TryEnqueue(uint32_t version, uint16_t first,
+                                uint16_t count, bool force, bool periodic) {
+  if (queue_ == nullptr || count == 0) {
+    return 0;
+  }
+  WakeJob job;
+  job.id = next_job_id_++;
+  if (job.id == 0) {
+    job.id = next_job_id_++;  // 0 is reserved for errors
+  }
+  job.version = version;
+  job.first = first;
+  job.count = count;
+  job.force = force;
+  job.periodic = periodic;
+  pending_packets_ += count;
+  if (xQueueSend(queue_, &job, 0) != pdTRUE) {
+    pending_packets_ -= count;
+    return 0;
+  }
+  return job.id;
+}
+
+uint32_t WakeEngine::FreeSlots() {
+  return queue_ == nullptr ? 0 : uxQueueSpacesAvailable(queue_);
+}
+
+void WakeEngine::Task(void *parameter) {
+  WakeJob job;
+  for (;;) {
+    if (xQueueReceive(queue_, &job, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    uint16_t sent = 0;
+    while (sent < job.count) {
+      const uint16_t burst = AcquireTokens(job.count - sent);
+      if (!send_(job, job.first + sent, burst)) {
+        // A reload changed the device indices, the tokens weren't used.
+        tokens_ = std::min(tokens_ + burst * kTokenUnit, bucket_size_);
+        break;
+      }
+      sent += burst;
+      pending_packets_ -= burst;
+    }
+    if (sent < job.count) {
+      pending_packets_ -= job.count - sent;
+      continue;
+    }
+    completed_jobs_++;
+    last_completed_job_ = job.id;
+    if (done_ != nullptr) {
+      done_(job);
+    }
+  }
+}
+
+// Blocks until at least one token is available, then takes up to `wanted`.
+uint16_t WakeEngine::AcquireTokens(uint16_t wanted) {
+  for (;;) {
+    const int64_t now = esp_timer_get_time();
+    tokens_ += (uint64_t)(now - last_refill_) * rate_;
+    last_refill_ = now;
+    if (tokens_ > bucket_size_) {
+      tokens_ = bucket_size_;
+    }
+    if (tokens_ >= kTokenUnit) {
+      uint16_t granted = tokens_ / kTokenUnit;
+      if (granted > wanted) {
+        granted = wanted;
+      }
+      tokens_ -= granted * kTokenUnit;
+      return granted;
+    }
+    // Sleep until the next token is due, at least one tick.
+    const uint64_t wait_us = (kTokenUnit - tokens_ + rate_ - 1) / rate_;
+    TickType_t ticks = pdMS_TO_TICKS((wait_us + 999) / 1000);
+    vTaskDelay(ticks ? ticks : 1);
+  }
+}
@@ -0,0 +1,80 @@
+#ifndef SRC_WAKEENGINE_H_
+#define SRC_WAKEENGINE_H_
+
+/*
+ *
+ * WakeEngine.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Background sender for Wake on Lan packets. Wake jobs are queued from the
+Arduino loop or the web server and sent from a dedicated task, paced by a
+token bucket so a long device list never blocks the caller. All packets the
+bucket allows at once are handed to the sender as a single burst.
+*/
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#define WAKE_ENGINE_QUEUE_LENGTH 16
+#define WAKE_ENGINE_STACK_SIZE 4096
+#define WAKE_ENGINE_PRIORITY 2
+
+// A range of WOL targets to wake, identified by a job id
+struct WakeJob {
+  uint32_t id;
+  uint32_t version;  // of the config snapshot first and count refer to
+  uint16_t first;
+  uint16_t count;
+  bool force;  // wake devices even if they are known to be online
+  bool periodic;  // the scheduled wake of all devices, or its early start
+};
+
+class WakeEngine {
+ public:
+  // Returns false if the job refers to an older config snapshot, which drops
+  // the rest of it.
+  typedef bool (*SendFn)(const WakeJob &job, size_t first, size_t count);
+  typedef void (*JobDoneFn)(const WakeJob &job);
+
+  static bool Setup(SendFn send, JobDoneFn done, uint16_t rate,
+                    uint16_t burst);
+  // Returns the id of the queued job, or 0 if the queue is full.
+  static uint32_t Enqueue(uint32_t version, uint16_t first, uint16_t count,
+                          bool force = true, bool periodic = false);
+  // Same without logging a full queue, for callers that retry later
+  static uint32_t TryEnqueue(uint32_t version, uint16_t first, uint16_t count,
+                             bool force = true, bool periodic = false);
+  static uint32_t FreeSlots();
+  static uint32_t PendingPackets() { return pending_packets_; }
+  static uint32_t CompletedJobs() { return completed_jobs_; }
+  static uint32_t LastCompletedJob() { return last_completed_job_; }
+
+ private:
+  static void Task(void *parameter);
+  static uint16_t AcquireTokens(uint16_t wanted);
+
+  static SendFn send_;
+  static JobDoneFn done_;
+  static QueueHandle_t queue_;
+  static uint32_t rate_;
+  static uint64_t bucket_size_;
+  static uint64_t tokens_;
+  static int64_t last_refill_;
+  static std::atomic<uint32_t> next_job_id_;
+  static std::atomic<uint32_t> pending_packets_;
+  static std::atomic<uint32_t> completed_jobs_;
+  static std::atomic<uint32_t> last_completed_job_;
+};
+
+#endif  // SRC_WAKEENGINE_H_
@@ -0,0 +1,231 @@
+/*
+ *
+ * WakeSequencer.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "WakeSequencer.h"
+
+#include <algorithm>
+
+#include "ProbeEngine.h"
+#include "WakeEngine.h"
+
+std::vector<uint32_t> WakeSequencer::depends_offset_;
+std::vector<uint16_t> WakeSequencer::depends_;
+std::vector<uint16_t> WakeSequencer::order_;
+std::vector<WakeSequencer::DeviceState> WakeSequencer::states_;
+std::vector<int64_t> WakeSequencer::released_;
+std::vector<uint32_t> WakeSequencer::wol_answers_;
+uint16_t WakeSequencer::max_concurrent_ = 0;
+int64_t WakeSequencer::boot_timeout_ = 0;
+WakeSequencer::RunDoneFn WakeSequencer::done_ = nullptr;
+bool WakeSequencer::trivial_ = true;
+bool WakeSequencer::running_ = false;
+bool WakeSequencer::force_ = true;
+uint32_t WakeSequencer::version_ = 0;
+int64_t WakeSequencer::last_tick_ = 0;
+
+bool WakeSequencer::Setup(
+    const std::vector<std::vector<uint16_t>> &depends_on,
+    const std::vector<int16_t> &priorities, uint16_t max_concurrent,
+    uint16_t boot_timeout, RunDoneFn done) {
+  const size_t count = depends_on.size();
+
+  // Kahn's algorithm, every device has to be reachable without a cycle.
+  // The dependents of device d are dependents[dependents_offset[d]] to
+  // dependents[dependents_offset[d + 1] - 1].
+  std::vector<uint32_t> dependents_offset(count + 1, 0);
+  for (const std::vector<uint16_t> &depends : depends_on) {
+    for (uint16_t dependency : depends) {
+      dependents_offset[dependency + 1]++;
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    dependents_offset[i + 1] += dependents_offset[i];
+  }
+  std::vector<uint16_t> dependents(dependents_offset[count]);
+  std::vector<uint32_t> next(dependents_offset.begin(),
+                             dependents_offset.end() - 1);
+  std::vector<uint16_t> unresolved(count);
+  std::vector<uint16_t> ready;
+  for (size_t i = 0; i < count; ++i) {
+    for (uint16_t dependency : depends_on[i]) {
+      dependents[next[dependency]++] = i;
+    }
+    unresolved[i] = depends_on[i].size();
+    if (unresolved[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  size_t resolved = 0;
+  while (!ready.empty()) {
+    const uint16_t device = ready.back();
+    ready.pop_back();
+    resolved++;
+    for (uint32_t i = dependents_offset[device];
+         i < dependents_offset[device + 1]; ++i) {
+      if (--unresolved[dependents[i]] == 0) {
+        ready.push_back(dependents[i]);
+      }
+    }
+  }
+  if (resolved != count) {
+    return false;  // leaves the current setup untouched
+  }
+
+  depends_offset_.assign(1, 0);
+  depends_.clear();
+  for (const std::vector<uint16_t> &depends : depends_on) {
+    depends_.insert(depends_.end(), depends.begin(), depends.end());
+    depends_offset_.push_back(depends_.size());
+  }
+
+  order_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    order_[i] = i;
+  }
+  std::stable_sort(order_.begin(), order_.end(),
+                   [&priorities](uint16_t left, uint16_t right) {
+                     return priorities[left] > priorities[right];
+                   });
+
+  // A run in progress refers to the old device indices, drop it.
+  running_ = false;
+  states_.assign(count, kDone);
+  released_.assign(count, 0);
+  wol_answers_.assign(count, 0);
+  max_concurrent_ = max_concurrent;
+  boot_timeout_ = boot_timeout * 1000000LL;
+  done_ = done;
+  trivial_ = depends_.empty() && max_concurrent == 0 &&
+             std::all_of(priorities.begin(), priorities.end(),
+                         [&priorities](int16_t p) {
+                           return p == priorities.front();
+                         });
+  return true;
+}
+
+bool WakeSequencer::Start(bool force, uint32_t version) {
+  if (running_) {
+    return false;
+  }
+  std::fill(states_.begin(), states_.end(), kPending);
+  force_ = force;
+  version_ = version;
+  last_tick_ = 0;
+  running_ = true;
+  Tick();
+  return true;
+}
+
+void WakeSequencer::Tick() {
+  if (!running_) {
+    return;
+  }
+  const int64_t now = esp_timer_get_time();
+  if (now - last_tick_ < WAKE_SEQUENCER_TICK_MS * 1000LL) {
+    return;
+  }
+  last_tick_ = now;
+
+  uint16_t booting = 0;
+  for (size_t i = 0; i < states_.size(); ++i) {
+    if (states_[i] != kBooting) {
+      continue;
+    }
+    // A forced wake is only done once the device answered it, even if it
+    // was online before.
+    const bool up = force_ ? ProbeEngine::WolAnswers(i) != wol_answers_[i]
+                           : ProbeEngine::IsOnline(i);
+    if (!ProbeEngine::IsProbed(i) || up) {
+      states_[i] = kDone;
+    } else if (now - released_[i] >= boot_timeout_) {
+      Serial.printf("Device %u didn't come up in time, releasing its "
+                    "dependents.\n", (unsigned)i);
+      states_[i] = kDone;
+    } else {
+      booting++;
+    }
+  }
+
+  // Ready devices with consecutive indices go out as one job. The release
+  // stops once the wake queue is down to its reserve, the rest is released
+  // by a later tick.
+  bool pending = false;
+  uint16_t run_first = 0;
+  uint16_t run_count = 0;
+  for (uint16_t i : order_) {
+    if (states_[i] != kPending) {
+      continue;
+    }
+    pending = true;
+    if (max_concurrent_ && booting + run_count >= max_concurrent_) {
+      break;
+    }
+    if (!DependenciesDone(i)) {
+      continue;
+    }
+    if (run_count != 0 && i != run_first + run_count) {
+      if (!Release(run_first, run_count, now)) {
+        run_count = 0;
+        break;
+      }
+      booting += run_count;
+      run_count = 0;
+    }
+    if (run_count == 0) {
+      run_first = i;
+    }
+    run_count++;
+  }
+  if (run_count != 0 && Release(run_first, run_count, now)) {
+    booting += run_count;
+  }
+
+  if (!pending && booting == 0) {
+    running_ = false;
+    if (done_ != nullptr) {
+      done_();
+    }
+  }
+}
+
+// Queues the wake of count devices from first on and marks them booting.
+// Returns false, leaving them pending, if the queue has no slot to spare.
+bool WakeSequencer::Release(uint16_t first, uint16_t count, int64_t now) {
+  if (WakeEngine::FreeSlots() <= WAKE_SEQUENCER_RESERVED_SLOTS) {
+    return false;
+  }
+  // Read before queueing, the answer to this wake mustn't count already.
+  // Only used once the device is booting.
+  for (uint16_t i = first; i < first + count; ++i) {
+    wol_answers_[i] = ProbeEngine::WolAnswers(i);
+  }
+  if (WakeEngine::TryEnqueue(version_, first, count, force_) == 0) {
+    return false;
+  }
+  for (uint16_t i = first; i < first + count; ++i) {
+    states_[i] = kBooting;
+    released_[i] = now;
+  }
+  return true;
+}
+
+bool WakeSequencer::DependenciesDone(size_t index) {
+  for (uint32_t i = depends_offset_[index]; i < depends_offset_[index + 1];
+       ++i) {
+    if (states_[depends_[i]] != kDone) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,81 @@
+#ifndef SRC_WAKESEQUENCER_H_
+#define SRC_WAKESEQUENCER_H_
+
+/*
+ *
+ * WakeSequencer.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Wakes all devices in dependency order. A device is only released to the
+wake engine once every device it depends on is online or timed out, higher
+priorities go first, and no more than max_concurrent_boots devices boot at
+the same time. Devices without a probe count as booted as soon as they are
+released, there is no way to tell when they are up. On forced runs a device
+that was online already only counts as booted once it answered a probe
+after its WOL packet.
+Driven by Tick() from the Arduino loop, it never blocks.
+*/
+
+#include <Arduino.h>
+
+#include <vector>
+
+#define WAKE_SEQUENCER_TICK_MS 100
+// Wake queue slots a run leaves to web and API wakes
+#define WAKE_SEQUENCER_RESERVED_SLOTS 4
+
+class WakeSequencer {
+ public:
+  typedef void (*RunDoneFn)();
+
+  // depends_on[i] lists the devices device i depends on. Returns false if the
+  // dependencies contain a cycle. Can be called again after a config reload,
+  // which ends a run in progress.
+  static bool Setup(const std::vector<std::vector<uint16_t>> &depends_on,
+                    const std::vector<int16_t> &priorities,
+                    uint16_t max_concurrent, uint16_t boot_timeout,
+                    RunDoneFn done);
+  // Starts a run over all devices of the given config version. Without
+  // force, online devices are only verified. Ignored while a run is in
+  // progress.
+  static bool Start(bool force, uint32_t version);
+  static void Tick();
+  static bool Running() { return running_; }
+  // True if a plain burst to all devices does the same as a sequenced run
+  static bool Trivial() { return trivial_; }
+
+ private:
+  enum DeviceState : uint8_t { kPending, kBooting, kDone };
+
+  static bool DependenciesDone(size_t index);
+  static bool Release(uint16_t first, uint16_t count, int64_t now);
+
+  // Dependencies in compressed row form, those of device i are
+  // depends_[depends_offset_[i]] to depends_[depends_offset_[i + 1] - 1].
+  static std::vector<uint32_t> depends_offset_;
+  static std::vector<uint16_t> depends_;
+  static std::vector<uint16_t> order_;  // by priority, then config order
+  static std::vector<DeviceState> states_;
+  static std::vector<int64_t> released_;
+  static std::vector<uint32_t> wol_answers_;  // when released
+  static uint16_t max_concurrent_;
+  static int64_t boot_timeout_;
+  static RunDoneFn done_;
+  static bool trivial_;
+  static bool running_;
+  static bool force_;
+  static uint32_t version_;  // of the config the run wakes
+  static int64_t last_tick_;
+};
+
+#endif  // SRC_WAKESEQUENCER_H_
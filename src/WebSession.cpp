@@ -0,0 +1,183 @@
+/*
+ *
+ * WebSession.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "WebSession.h"
+
+#include <esp_random.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/md.h>
+
+#include <algorithm>
+
+String WebSession::user_;
+bool WebSession::salted_ = false;
+uint8_t WebSession::salt_[kSaltSize];
+uint8_t WebSession::hash_[kHashSize];
+uint8_t WebSession::key_[kHashSize];
+
+static const size_t kMaxCredentials = 128;  // decoded "user:password"
+
+static uint32_t Uptime() { return esp_timer_get_time() / 1000000; }
+
+static bool ParseHex(const char *hex, size_t digits, uint8_t *out) {
+  for (size_t i = 0; i < digits; ++i) {
+    const char c = hex[i];
+    uint8_t nibble;
+    if (c >= '0' && c <= '9') {
+      nibble = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      nibble = c - 'a' + 10;
+    } else {
+      return false;
+    }
+    out[i / 2] = i % 2 ? out[i / 2] | nibble : nibble << 4;
+  }
+  return true;
+}
+
+static void WriteHex(const uint8_t *data, size_t size, char *out) {
+  static const char kHex[] = "0123456789abcdef";
+  for (size_t i = 0; i < size; ++i) {
+    out[2 * i] = kHex[data[i] >> 4];
+    out[2 * i + 1] = kHex[data[i] & 0xF];
+  }
+}
+
+void WebSession::Hash(const String &password, PasswordHash &out) {
+  if (!salted_) {
+    esp_fill_random(salt_, sizeof(salt_));
+    salted_ = true;
+  }
+  memcpy(out.salt, salt_, kSaltSize);
+  HashPassword(password.c_str(), password.length(), out.hash);
+}
+
+void WebSession::Setup(const String &user, const PasswordHash &password) {
+  user_ = user;
+  memcpy(salt_, password.salt, kSaltSize);
+  memcpy(hash_, password.hash, kHashSize);
+  salted_ = true;
+  esp_fill_random(key_, sizeof(key_));
+}
+
+bool WebSession::Matches(const String &user, const PasswordHash &password) {
+  return user == user_ && Equal(password.salt, salt_, kSaltSize) &&
+         Equal(password.hash, hash_, kHashSize);
+}
+
+void WebSession::HashPassword(const char *password, size_t length,
+                              uint8_t *hash) {
+  uint8_t input[kSaltSize + kMaxCredentials];
+  length = std::min(length, kMaxCredentials);
+  memcpy(input, salt_, kSaltSize);
+  memcpy(input + kSaltSize, password, length);
+  mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), input,
+             kSaltSize + length, hash);
+}
+
+bool WebSession::CheckPassword(const char *user, const char *password) {
+  uint8_t hash[kHashSize];
+  HashPassword(password, strlen(password), hash);
+  // Both are checked, so the time taken doesn't tell which one was wrong
+  const bool user_ok = strlen(user) == user_.length() &&
+                       Equal(reinterpret_cast<const uint8_t *>(user),
+                             reinterpret_cast<const uint8_t *>(user_.c_str()),
+                             user_.length());
+  const bool password_ok = Equal(hash, hash_, kHashSize);
+  return user_ok & password_ok;
+}
+
+bool WebSession::CheckBasic(const char *authorization) {
+  if (strncmp(authorization, "Basic ", 6) != 0) {
+    return false;
+  }
+  const char *encoded = authorization + 6;
+  unsigned char decoded[kMaxCredentials + 1];
+  size_t length = 0;
+  if (mbedtls_base64_decode(decoded, kMaxCredentials, &length,
+                            reinterpret_cast<const unsigned char *>(encoded),
+                            strlen(encoded)) != 0) {
+    return false;
+  }
+  decoded[length] = '\0';
+  char *colon = strchr(reinterpret_cast<char *>(decoded), ':');
+  if (colon == nullptr) {
+    return false;
+  }
+  *colon = '\0';
+  return CheckPassword(reinterpret_cast<char *>(decoded), colon + 1);
+}
+
+void WebSession::Sign(uint32_t expiry, uint32_t nonce, uint8_t *mac) {
+  const uint8_t message[8] = {
+      (uint8_t)(expiry >> 24), (uint8_t)(expiry >> 16), (uint8_t)(expiry >> 8),
+      (uint8_t)expiry,         (uint8_t)(nonce >> 24),  (uint8_t)(nonce >> 16),
+      (uint8_t)(nonce >> 8),   (uint8_t)nonce};
+  uint8_t full[kHashSize];
+  mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), key_,
+                  sizeof(key_), message, sizeof(message), full);
+  memcpy(mac, full, kMacSize);
+}
+
+void WebSession::IssueToken(char *buf) {
+  const uint32_t expiry = Uptime() + WEB_SESSION_LIFETIME;
+  const uint32_t nonce = esp_random();
+  uint8_t mac[kMacSize];
+  Sign(expiry, nonce, mac);
+  snprintf(buf, kTokenSize, "%08x%08x", static_cast<unsigned>(expiry),
+           static_cast<unsigned>(nonce));
+  WriteHex(mac, kMacSize, buf + 16);
+  buf[kTokenSize - 1] = '\0';
+}
+
+bool WebSession::CheckCookie(const char *cookie) {
+  // Cookie: a=1; wol_session=<token>; b=2
+  const size_t name_length = strlen(WEB_SESSION_COOKIE);
+  const char *token = cookie;
+  while ((token = strstr(token, WEB_SESSION_COOKIE)) != nullptr) {
+    const bool starts =
+        token == cookie || token[-1] == ' ' || token[-1] == ';';
+    token += name_length;
+    if (starts && *token == '=') {
+      token++;
+      break;
+    }
+  }
+  if (token == nullptr || strnlen(token, kTokenSize) < kTokenSize - 1) {
+    return false;
+  }
+
+  uint8_t fields[8];
+  uint8_t mac[kMacSize];
+  uint8_t expected[kMacSize];
+  if (!ParseHex(token, 16, fields) ||
+      !ParseHex(token + 16, 2 * kMacSize, mac)) {
+    return false;
+  }
+  const uint32_t expiry = (uint32_t)fields[0] << 24 | fields[1] << 16 |
+                          fields[2] << 8 | fields[3];
+  const uint32_t nonce = (uint32_t)fields[4] << 24 | fields[5] << 16 |
+                         fields[6] << 8 | fields[7];
+  Sign(expiry, nonce, expected);
+  return Equal(mac, expected, kMacSize) && Uptime() < expiry;
+}
+
+// Takes the same time wherever the first difference is
+bool WebSession::Equal(const uint8_t *a, const uint8_t *b, size_t size) {
+  volatile uint8_t diff = 0;
+  for (size_t i = 0; i < size; ++i) {
+    diff |= a[i] ^ b[i];
+  }
+  return diff == 0;
+}
@@ -0,0 +1,74 @@
+#ifndef SRC_WEBSESSION_H_
+#define SRC_WEBSESSION_H_
+
+/*
+ *
+ * WebSession.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Login sessions of the web interface. The password is only kept as a salted
+SHA-256 hash, in memory and in the config cache. A login issues a session
+token, its expiry and a nonce signed with HMAC-SHA256 under a key drawn at
+boot, so all sessions end with a reboot. Checking a token costs one HMAC
+over 8 bytes, the expiry and nonce, no password hashing. Scripts can still
+send HTTP Basic credentials, which are checked against the hash. All
+secrets are compared in constant time.
+*/
+
+#include <Arduino.h>
+
+#define WEB_SESSION_COOKIE "wol_session"
+#define WEB_SESSION_LIFETIME (12 * 3600)  // s
+
+class WebSession {
+ public:
+  static const size_t kHashSize = 32;
+  static const size_t kSaltSize = 16;
+  static const size_t kMacSize = 16;  // of the token, truncated HMAC
+  // expiry and nonce as 8 hex digits each, the MAC as hex, '\0'
+  static const size_t kTokenSize = 16 + 2 * kMacSize + 1;
+
+  struct PasswordHash {
+    uint8_t salt[kSaltSize];
+    uint8_t hash[kHashSize];
+  };
+
+  // Hashes password with the salt in use, a fresh one before Setup(). A
+  // reloaded config thus gets the same hash for the same password.
+  static void Hash(const String &password, PasswordHash &out);
+  // Takes the password hash and draws a fresh signing key
+  static void Setup(const String &user, const PasswordHash &password);
+  // Whether user and password are the ones in use
+  static bool Matches(const String &user, const PasswordHash &password);
+  static bool CheckPassword(const char *user, const char *password);
+  // Checks the credentials of an "Authorization: Basic ..." header value
+  static bool CheckBasic(const char *authorization);
+  // Checks the session token in a Cookie header value
+  static bool CheckCookie(const char *cookie);
+  // Writes a new session token to buf, which holds kTokenSize bytes
+  static void IssueToken(char *buf);
+
+ private:
+  static void Sign(uint32_t expiry, uint32_t nonce, uint8_t *mac);
+  static void HashPassword(const char *password, size_t length,
+                           uint8_t *hash);
+  static bool Equal(const uint8_t *a, const uint8_t *b, size_t size);
+
+  static String user_;
+  static bool salted_;
+  static uint8_t salt_[kSaltSize];
+  static uint8_t hash_[kHashSize];
+  static uint8_t key_[kHashSize];
+};
+
+#endif /* SRC_WEBSESSION_H_ */
@@ -17,14 +17,14 @@
 #define YAML_DISABLE_ARDUINOJSON // disable all ArduinoJson functions
 #include <ArduinoYaml.h>  // Happy with plain YAML for out needs
 
-#include <Button.h>
+#include "Buttons.h"
 #include "Display.h"
 
+#include "Metrics.h"
 #include "NetworkHandler.h"
 #include "Timer.h"
 #include "esp_sntp.h"
 
-Timer timer_display(timer0);
 Timer timer_wol(timer1);
 I2CDisplay display(&timer_wol);
 
@@ -34,59 +34,64 @@ void setup() {
   Serial.begin(115200);
 
   display.Setup();
+  Buttons::Setup();
 
   while(!NetworkHandler::Setup(config_file)) { delay(2000); }
 
-  timer_display.Enable(DISPLAY_INTERVAL);
-  timer_wol.Enable(NetworkHandler::Config().wol_startup * 60);
+  display.StartRefresh(DISPLAY_INTERVAL);
+  timer_wol.Enable(NetworkHandler::Snapshot()->config.wol_startup * 60);
+  Serial.printf("WOL armed %lu ms after boot, config %s.\n", millis(),
+                NetworkHandler::ConfigCached() ? "from cache" : "parsed");
 }
 
 void loop() {
   static bool first_run = true;
   static time_t wol_epoche;
+  const int64_t loop_start = esp_timer_get_time();
   NetworkHandler::Loop();
 
   if (first_run) {
     time(&wol_epoche);
-    wol_epoche += NetworkHandler::Config().wol_startup * 60;
+    wol_epoche += NetworkHandler::Snapshot()->config.wol_startup * 60;
     NetworkHandler::SetNextWolTime(wol_epoche);
     first_run = false;
   }
 
-  if (timer_display.IsExpired()) {
-    display.DisplayCurrentPage();
-    timer_display.Clear();
-  }
-
   if (timer_wol.IsExpired()) {
     if (!NetworkHandler::FirstWolSent()) {
       // Reset Timer to new interval
-      timer_wol.SetTimer(NetworkHandler::Config().wol_repeat * 60);
+      timer_wol.SetTimer(NetworkHandler::Snapshot()->config.wol_repeat * 60);
       timer_wol.Restart();
     }
     time(&wol_epoche);
-    wol_epoche += NetworkHandler::Config().wol_repeat * 60;
+    wol_epoche += NetworkHandler::Snapshot()->config.wol_repeat * 60;
     NetworkHandler::SetNextWolTime(wol_epoche);
-    NetworkHandler::SendWol();
+    NetworkHandler::SendPeriodicWol();
     timer_wol.Clear();
   }
 
-  if (display.ButtonUpPressed()) {
-    display.DisplayPreviousPage();
-  }
-  if (display.ButtonDownPressed()) {
-    display.DisplayNextPage();
-  }
-  if (display.ButtonHashPressed()) {
-  }
-
-  if (display.ButtonStarPressed()) {
-    time(&wol_epoche);
-    wol_epoche += NetworkHandler::Config().wol_repeat * 60;
-    NetworkHandler::SetNextWolTime(wol_epoche);
-    timer_wol.Clear();
-    timer_wol.SetTimer(NetworkHandler::Config().wol_repeat * 60);
-    timer_wol.Restart();
-    NetworkHandler::SendWol();
+  ButtonEvent button;
+  while (Buttons::Read(button)) {
+    switch (button.button) {
+      case kButtonUp:
+        display.PreviousPage();
+        break;
+      case kButtonDown:
+        display.NextPage();
+        break;
+      case kButtonStar:
+        time(&wol_epoche);
+        wol_epoche += NetworkHandler::Snapshot()->config.wol_repeat * 60;
+        NetworkHandler::SetNextWolTime(wol_epoche);
+        timer_wol.Clear();
+        timer_wol.SetTimer(NetworkHandler::Snapshot()->config.wol_repeat * 60);
+        timer_wol.Restart();
+        NetworkHandler::SendWol();
+        break;
+      default:
+        break;
+    }
   }
+  Metrics::loop_latency.Observe(esp_timer_get_time() - loop_start);
+  Buttons::Wait(LOOP_IDLE_MS);
 }
@@ -21,6 +21,8 @@
 #include <SPI.h>
 #include <SD.h>
 
+#define LOOP_IDLE_MS 10  // longest loop() waits for a button between runs
+
 #ifdef ESP32
 void setup();
 void loop();
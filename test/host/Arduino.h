@@ -0,0 +1,364 @@
+#ifndef TEST_HOST_ARDUINO_H_
+#define TEST_HOST_ARDUINO_H_
+
+/*
+ *
+ * Arduino.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Just enough of the Arduino core and FreeRTOS for the modules under test to
+build and run on the host with the native environment. Tasks are detached
+threads, critical sections are mutexes and esp_timer_get_time() is the
+steady clock. Queues copy their items like FreeRTOS does. Interrupt
+handlers run in the thread that sets the pin. String wraps std::string,
+Serial prints to stdout.
+*/
+
+#include <arpa/inet.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef void *TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdPASS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+struct portMUX_TYPE {
+  std::mutex lock;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED \
+  {}
+#define portENTER_CRITICAL(mux) (mux)->lock.lock()
+#define portEXIT_CRITICAL(mux) (mux)->lock.unlock()
+#define portENTER_CRITICAL_ISR(mux) (mux)->lock.lock()
+#define portEXIT_CRITICAL_ISR(mux) (mux)->lock.unlock()
+#define portYIELD_FROM_ISR()
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+// Tests skip ahead in time by adding to it
+inline int64_t host_clock_offset_us = 0;
+
+inline int64_t esp_timer_get_time() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+             .count() +
+         host_clock_offset_us;
+}
+
+inline unsigned long millis() { return esp_timer_get_time() / 1000; }
+inline unsigned long micros() { return esp_timer_get_time(); }
+
+inline void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+inline BaseType_t xTaskCreate(void (*task)(void *), const char *name,
+                              uint32_t stack_size, void *parameter,
+                              UBaseType_t priority, TaskHandle_t *handle) {
+  std::thread(task, parameter).detach();
+  if (handle != nullptr) {
+    *handle = (TaskHandle_t)task;  // only compared against nullptr
+  }
+  return pdPASS;
+}
+
+// FreeRTOS queue of fixed size items, copied in and out like the original
+struct HostQueue {
+  std::mutex lock;
+  std::condition_variable changed;
+  std::deque<std::vector<uint8_t>> items;
+  size_t length;
+  size_t item_size;
+};
+
+typedef HostQueue *QueueHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  HostQueue *queue = new HostQueue();
+  queue->length = length;
+  queue->item_size = item_size;
+  return queue;
+}
+
+inline void vQueueDelete(QueueHandle_t queue) { delete queue; }
+
+// Waits until ready() holds or ticks (milliseconds) passed
+template <typename Ready>
+inline bool HostQueueWait(QueueHandle_t queue,
+                          std::unique_lock<std::mutex> &lock, TickType_t ticks,
+                          Ready ready) {
+  if (ticks == portMAX_DELAY) {
+    queue->changed.wait(lock, ready);
+    return true;
+  }
+  return queue->changed.wait_for(lock, std::chrono::milliseconds(ticks),
+                                 ready);
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item,
+                             TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(queue->lock);
+  if (!HostQueueWait(queue, lock, ticks, [queue] {
+        return queue->items.size() < queue->length;
+      })) {
+    return pdFALSE;
+  }
+  const uint8_t *bytes = static_cast<const uint8_t *>(item);
+  queue->items.emplace_back(bytes, bytes + queue->item_size);
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+inline BaseType_t HostQueueRead(QueueHandle_t queue, void *item,
+                                TickType_t ticks, bool remove) {
+  std::unique_lock<std::mutex> lock(queue->lock);
+  if (!HostQueueWait(queue, lock, ticks,
+                     [queue] { return !queue->items.empty(); })) {
+    return pdFALSE;
+  }
+  memcpy(item, queue->items.front().data(), queue->item_size);
+  if (remove) {
+    queue->items.pop_front();
+    queue->changed.notify_all();
+  }
+  return pdTRUE;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item,
+                                TickType_t ticks) {
+  return HostQueueRead(queue, item, ticks, true);
+}
+
+inline BaseType_t xQueuePeek(QueueHandle_t queue, void *item,
+                             TickType_t ticks) {
+  return HostQueueRead(queue, item, ticks, false);
+}
+
+inline BaseType_t xQueueReset(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(queue->lock);
+  queue->items.clear();
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+// Task notifications, counting like ulTaskNotifyTake() uses them. The handle
+// of a task is its notification count.
+struct HostNotification {
+  std::mutex lock;
+  std::condition_variable given;
+  uint32_t count = 0;
+};
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+  thread_local HostNotification notification;
+  return &notification;
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+  HostNotification *notification = static_cast<HostNotification *>(task);
+  std::lock_guard<std::mutex> lock(notification->lock);
+  notification->count++;
+  notification->given.notify_all();
+  if (woken != nullptr) {
+    *woken = pdTRUE;
+  }
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+  HostNotification *notification =
+      static_cast<HostNotification *>(xTaskGetCurrentTaskHandle());
+  std::unique_lock<std::mutex> lock(notification->lock);
+  notification->given.wait_for(lock, std::chrono::milliseconds(ticks),
+                               [notification] {
+                                 return notification->count > 0;
+                               });
+  const uint32_t count = notification->count;
+  if (count > 0) {
+    notification->count = clear ? 0 : count - 1;
+  }
+  return count;
+}
+
+// GPIO pins whose levels the tests set with host_set_pin(), which calls the
+// attached interrupt handler on a change like a CHANGE interrupt does.
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define INPUT_PULLUP 0x05
+#define CHANGE 0x03
+#define HOST_PINS 40
+
+struct HostPin {
+  int level = LOW;
+  void (*handler)(void *) = nullptr;
+  void *arg = nullptr;
+};
+
+inline HostPin host_pins[HOST_PINS];
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+  if (mode == INPUT_PULLUP) {
+    host_pins[pin].level = HIGH;
+  }
+}
+
+inline int digitalRead(uint8_t pin) { return host_pins[pin].level; }
+
+inline void attachInterruptArg(uint8_t pin, void (*handler)(void *),
+                               void *arg, int mode) {
+  host_pins[pin].handler = handler;
+  host_pins[pin].arg = arg;
+}
+
+inline void host_set_pin(uint8_t pin, int level) {
+  if (host_pins[pin].level == level) {
+    return;
+  }
+  host_pins[pin].level = level;
+  if (host_pins[pin].handler != nullptr) {
+    host_pins[pin].handler(host_pins[pin].arg);
+  }
+}
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char *dst, const char *src, size_t size) {
+  const size_t len = strlen(src);
+  if (size > 0) {
+    const size_t copy = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, copy);
+    dst[copy] = '\0';
+  }
+  return len;
+}
+#endif
+
+class String {
+ public:
+  String() {}
+  String(const char *str) : str_(str != nullptr ? str : "") {}
+  String(const std::string &str) : str_(str) {}
+
+  const char *c_str() const { return str_.c_str(); }
+  unsigned length() const { return str_.size(); }
+  bool isEmpty() const { return str_.empty(); }
+  int indexOf(char c) const {
+    const size_t pos = str_.find(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+  }
+  String substring(unsigned from) const { return str_.substr(from); }
+  String substring(unsigned from, unsigned to) const {
+    return str_.substr(from, to - from);
+  }
+  long toInt() const { return atol(str_.c_str()); }
+  bool startsWith(const String &prefix) const {
+    return str_.compare(0, prefix.str_.size(), prefix.str_) == 0;
+  }
+  bool operator==(const String &other) const { return str_ == other.str_; }
+  bool operator!=(const String &other) const { return str_ != other.str_; }
+  bool operator<(const String &other) const { return str_ < other.str_; }
+
+ private:
+  std::string str_;
+};
+
+class IPAddress {
+ public:
+  IPAddress() : address_(0) {}
+  explicit IPAddress(uint32_t address) : address_(address) {}
+  // Dotted quad only, like the Arduino core
+  bool fromString(const char *str) {
+    return inet_pton(AF_INET, str, &address_) == 1;
+  }
+  bool fromString(const String &str) { return fromString(str.c_str()); }
+  operator uint32_t() const { return address_; }
+
+ private:
+  uint32_t address_;  // in network byte order
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *data, size_t size) {
+    size_t n = 0;
+    while (n < size && write(data[n]) == 1) {
+      n++;
+    }
+    return n;
+  }
+
+  size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+  size_t print(const char *str) {
+    return write(reinterpret_cast<const uint8_t *>(str), strlen(str));
+  }
+  size_t print(const String &str) { return print(str.c_str()); }
+  size_t print(long value) { return printf("%ld", value); }
+  size_t print(unsigned long value) { return printf("%lu", value); }
+  size_t println(const char *str) { return print(str) + print('\n'); }
+  size_t println(const String &str) { return println(str.c_str()); }
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    const int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len <= 0) {
+      return 0;
+    }
+    return write(reinterpret_cast<const uint8_t *>(buf),
+                 (size_t)len < sizeof(buf) ? len : sizeof(buf) - 1);
+  }
+};
+
+class HardwareSerial : public Print {
+ public:
+  size_t write(uint8_t c) override { return fputc(c, stdout) != EOF; }
+  size_t write(const uint8_t *data, size_t size) override {
+    return fwrite(data, 1, size, stdout);
+  }
+};
+
+inline HardwareSerial Serial;
+
+// There is no fixed heap on the host
+class EspClass {
+ public:
+  uint32_t getFreeHeap() { return 0; }
+};
+
+inline EspClass ESP;
+
+#endif  // TEST_HOST_ARDUINO_H_
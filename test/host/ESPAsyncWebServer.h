@@ -0,0 +1,89 @@
+#ifndef TEST_HOST_ESPASYNCWEBSERVER_H_
+#define TEST_HOST_ESPASYNCWEBSERVER_H_
+
+/*
+ *
+ * ESPAsyncWebServer.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+The event source of the web server, without a network. Tests connect
+simulated clients with Connect() and read back what was sent from sent().
+*/
+
+#include <Arduino.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class AsyncWebServerRequest;
+class AsyncEventSourceClient;
+
+typedef std::function<bool(AsyncWebServerRequest *request)>
+    ArRequestFilterFunction;
+typedef std::function<void(AsyncEventSourceClient *client)>
+    ArEventHandlerFunction;
+
+class AsyncWebHandler {
+ public:
+  virtual ~AsyncWebHandler() {}
+};
+
+class AsyncEventSource : public AsyncWebHandler {
+ public:
+  struct Message {
+    std::string event;
+    std::string data;
+  };
+
+  explicit AsyncEventSource(const char *url) : clients_(0) {}
+
+  void setFilter(ArRequestFilterFunction filter) { filter_ = filter; }
+  void onConnect(ArEventHandlerFunction handler) { on_connect_ = handler; }
+  size_t count() const { return clients_; }
+  void send(const char *message, const char *event = nullptr, uint32_t id = 0,
+            uint32_t reconnect = 0) {
+    sent_.push_back({event != nullptr ? event : "", message});
+  }
+
+  // A client is accepted if the filter lets it through
+  bool Connect() {
+    if (filter_ && !filter_(nullptr)) {
+      return false;
+    }
+    clients_++;
+    if (on_connect_) {
+      on_connect_(nullptr);
+    }
+    return true;
+  }
+  void Disconnect() { clients_--; }
+  std::vector<Message> &sent() { return sent_; }
+
+ private:
+  size_t clients_;
+  ArRequestFilterFunction filter_;
+  ArEventHandlerFunction on_connect_;
+  std::vector<Message> sent_;
+};
+
+class AsyncWebServer {
+ public:
+  void addHandler(AsyncWebHandler *handler) { handlers_.push_back(handler); }
+  const std::vector<AsyncWebHandler *> &handlers() const { return handlers_; }
+
+ private:
+  std::vector<AsyncWebHandler *> handlers_;
+};
+
+#endif  // TEST_HOST_ESPASYNCWEBSERVER_H_
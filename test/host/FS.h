@@ -0,0 +1,44 @@
+#ifndef TEST_HOST_FS_H_
+#define TEST_HOST_FS_H_
+
+/*
+ *
+ * FS.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <string>
+
+namespace fs {
+
+// A file read from memory
+class File {
+ public:
+  explicit File(const std::string &data) : data_(data), position_(0) {}
+
+  size_t read(uint8_t *buf, size_t size) {
+    const size_t count = std::min(size, data_.size() - position_);
+    memcpy(buf, data_.data() + position_, count);
+    position_ += count;
+    return count;
+  }
+
+ private:
+  std::string data_;
+  size_t position_;
+};
+
+}  // namespace fs
+
+#endif  // TEST_HOST_FS_H_
@@ -0,0 +1,35 @@
+#ifndef TEST_HOST_ESP_RANDOM_H_
+#define TEST_HOST_ESP_RANDOM_H_
+
+/*
+ *
+ * esp_random.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <random>
+
+inline uint32_t esp_random() {
+  static std::random_device device;
+  return device();
+}
+
+inline void esp_fill_random(void *buf, size_t len) {
+  uint8_t *out = static_cast<uint8_t *>(buf);
+  for (size_t i = 0; i < len; ++i) {
+    out[i] = esp_random();
+  }
+}
+
+#endif  // TEST_HOST_ESP_RANDOM_H_
@@ -0,0 +1,21 @@
+#ifndef TEST_HOST_LIBYAML_YAML_H_
+#define TEST_HOST_LIBYAML_YAML_H_
+
+/*
+ *
+ * yaml.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+// The libyaml of the host, YAMLDuino ships it as libyaml/yaml.h
+#include <yaml.h>
+
+#endif  // TEST_HOST_LIBYAML_YAML_H_
@@ -0,0 +1,27 @@
+#ifndef TEST_HOST_LWIP_ERR_H_
+#define TEST_HOST_LWIP_ERR_H_
+
+/*
+ *
+ * err.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <stdint.h>
+
+// lwIP error codes, the values of lwip/err.h
+
+typedef int8_t err_t;
+
+#define ERR_OK 0
+#define ERR_RTE -4
+
+#endif  // TEST_HOST_LWIP_ERR_H_
@@ -0,0 +1,35 @@
+#ifndef TEST_HOST_LWIP_ETHARP_H_
+#define TEST_HOST_LWIP_ETHARP_H_
+
+/*
+ *
+ * etharp.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "lwip/err.h"
+#include "lwip/ip4.h"
+
+struct eth_addr {
+  uint8_t addr[6];
+};
+
+inline err_t etharp_request(struct netif *netif, const ip4_addr_t *ipaddr) {
+  return ERR_RTE;
+}
+
+inline int8_t etharp_find_addr(struct netif *netif, const ip4_addr_t *ipaddr,
+                               struct eth_addr **eth_ret,
+                               const ip4_addr_t **ip_ret) {
+  return -1;
+}
+
+#endif  // TEST_HOST_LWIP_ETHARP_H_
@@ -0,0 +1,37 @@
+#ifndef TEST_HOST_LWIP_INET_CHKSUM_H_
+#define TEST_HOST_LWIP_INET_CHKSUM_H_
+
+/*
+ *
+ * inet_chksum.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Internet checksum of RFC 1071, in network byte order like lwIP's
+inline uint16_t inet_chksum(const void *data, uint16_t len) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  uint32_t sum = 0;
+  for (size_t i = 0; i + 1 < len; i += 2) {
+    sum += (uint16_t)(bytes[i] | bytes[i + 1] << 8);
+  }
+  if (len & 1) {
+    sum += bytes[len - 1];
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return (uint16_t)~sum;
+}
+
+#endif  // TEST_HOST_LWIP_INET_CHKSUM_H_
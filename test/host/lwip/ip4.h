@@ -0,0 +1,33 @@
+#ifndef TEST_HOST_LWIP_IP4_H_
+#define TEST_HOST_LWIP_IP4_H_
+
+/*
+ *
+ * ip4.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+// There is no lwIP netif on the host, so ip4_route() finds no route and
+// ARP probes always fail.
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t addr;
+} ip4_addr_t;
+
+struct netif;
+
+#define ip4_addr_set_u32(dest, src) ((dest)->addr = (src))
+
+inline struct netif *ip4_route(const ip4_addr_t *dest) { return nullptr; }
+
+#endif  // TEST_HOST_LWIP_IP4_H_
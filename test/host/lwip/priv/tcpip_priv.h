@@ -0,0 +1,30 @@
+#ifndef TEST_HOST_LWIP_PRIV_TCPIP_PRIV_H_
+#define TEST_HOST_LWIP_PRIV_TCPIP_PRIV_H_
+
+/*
+ *
+ * tcpip_priv.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include "lwip/err.h"
+
+struct tcpip_api_call_data {};
+
+typedef err_t (*tcpip_api_call_fn)(struct tcpip_api_call_data *call);
+
+// There is no tcpip thread on the host, the call runs right away.
+inline err_t tcpip_api_call(tcpip_api_call_fn fn,
+                            struct tcpip_api_call_data *call) {
+  return fn(call);
+}
+
+#endif  // TEST_HOST_LWIP_PRIV_TCPIP_PRIV_H_
@@ -0,0 +1,35 @@
+#ifndef TEST_HOST_LWIP_PROT_ICMP_H_
+#define TEST_HOST_LWIP_PROT_ICMP_H_
+
+/*
+ *
+ * icmp.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <stdint.h>
+
+#define ICMP_ER 0
+#define ICMP_ECHO 8
+
+struct icmp_echo_hdr {
+  uint8_t type;
+  uint8_t code;
+  uint16_t chksum;
+  uint16_t id;
+  uint16_t seqno;
+};
+
+#define ICMPH_TYPE(hdr) ((hdr)->type)
+#define ICMPH_TYPE_SET(hdr, t) ((hdr)->type = (t))
+#define ICMPH_CODE_SET(hdr, c) ((hdr)->code = (c))
+
+#endif  // TEST_HOST_LWIP_PROT_ICMP_H_
@@ -0,0 +1,37 @@
+#ifndef TEST_HOST_LWIP_PROT_IP4_H_
+#define TEST_HOST_LWIP_PROT_IP4_H_
+
+/*
+ *
+ * ip4.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <stdint.h>
+
+#define IP_PROTO_ICMP 1
+
+struct ip_hdr {
+  uint8_t _v_hl;
+  uint8_t _tos;
+  uint16_t _len;
+  uint16_t _id;
+  uint16_t _offset;
+  uint8_t _ttl;
+  uint8_t _proto;
+  uint16_t _chksum;
+  uint32_t src;
+  uint32_t dest;
+};
+
+#define IPH_HL_BYTES(hdr) ((uint8_t)(((hdr)->_v_hl & 0x0f) * 4))
+
+#endif  // TEST_HOST_LWIP_PROT_IP4_H_
@@ -0,0 +1,28 @@
+#ifndef TEST_HOST_LWIP_SOCKETS_H_
+#define TEST_HOST_LWIP_SOCKETS_H_
+
+/*
+ *
+ * sockets.h
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+// The lwIP socket API is the BSD one of the host
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#endif  // TEST_HOST_LWIP_SOCKETS_H_
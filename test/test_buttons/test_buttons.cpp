@@ -0,0 +1,174 @@
+/*
+ *
+ * test_buttons.cpp
+ *
+ * Created on: 2026-10-18
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Simulated presses of the buttons. Setting a pin runs the interrupt handler
+right away, the clock is moved forward by hand between the edges. Held
+times are checked with a little slack for the real time that passes.
+*/
+
+#include <Buttons.h>
+#include <unity.h>
+
+#include <chrono>
+
+#define HELD_SLACK_MS 5
+
+static void Advance(uint32_t ms) { host_clock_offset_us += ms * 1000LL; }
+
+static void Press(uint8_t pin) { host_set_pin(pin, LOW); }
+static void Release(uint8_t pin) { host_set_pin(pin, HIGH); }
+
+// Every test starts with all buttons released and settled, no events left
+void setUp() {
+  Advance(1000);
+  ButtonEvent event;
+  while (Buttons::Read(event)) {
+  }
+  ulTaskNotifyTake(pdTRUE, 0);
+}
+void tearDown() {}
+
+static void test_press() {
+  Press(BUTTON_UP);
+  Advance(120);
+  Release(BUTTON_UP);
+  ButtonEvent event;
+  TEST_ASSERT_TRUE(Buttons::Read(event));
+  TEST_ASSERT_EQUAL(kButtonUp, event.button);
+  TEST_ASSERT_FALSE(event.long_press);
+  TEST_ASSERT_UINT32_WITHIN(HELD_SLACK_MS, 120, event.held);
+  TEST_ASSERT_FALSE(Buttons::Read(event));
+}
+
+static void test_long_press() {
+  Press(BUTTON_STAR);
+  Advance(BUTTON_LONG_PRESS_MS + 100);
+  Release(BUTTON_STAR);
+  ButtonEvent event;
+  TEST_ASSERT_TRUE(Buttons::Read(event));
+  TEST_ASSERT_EQUAL(kButtonStar, event.button);
+  TEST_ASSERT_TRUE(event.long_press);
+}
+
+// Bounces after the press are one press, timed from its first edge
+static void test_bounce() {
+  Press(BUTTON_DOWN);
+  Advance(1);
+  Release(BUTTON_DOWN);
+  Advance(1);
+  Press(BUTTON_DOWN);
+  Advance(200);
+  Release(BUTTON_DOWN);
+  ButtonEvent event;
+  TEST_ASSERT_TRUE(Buttons::Read(event));
+  TEST_ASSERT_EQUAL(kButtonDown, event.button);
+  TEST_ASSERT_UINT32_WITHIN(HELD_SLACK_MS, 202, event.held);
+  Advance(BUTTON_DEBOUNCE_MS);
+  TEST_ASSERT_FALSE(Buttons::Read(event));
+}
+
+// A release within the debounce window is taken once the window is over
+static void test_early_release_resampled() {
+  Press(BUTTON_HASH);
+  Advance(BUTTON_DEBOUNCE_MS - 20);
+  Release(BUTTON_HASH);
+  ButtonEvent event;
+  TEST_ASSERT_FALSE(Buttons::Read(event));
+  Advance(25);
+  TEST_ASSERT_TRUE(Buttons::Read(event));
+  TEST_ASSERT_EQUAL(kButtonHash, event.button);
+  TEST_ASSERT_UINT32_WITHIN(HELD_SLACK_MS, BUTTON_DEBOUNCE_MS + 5,
+                            event.held);
+  TEST_ASSERT_FALSE(Buttons::Read(event));
+}
+
+// A bounce back within the window leaves nothing to resample
+static void test_bounce_back_settles() {
+  Press(BUTTON_UP);
+  Advance(10);
+  Release(BUTTON_UP);
+  Advance(1);
+  Press(BUTTON_UP);
+  Advance(BUTTON_DEBOUNCE_MS);
+  ButtonEvent event;
+  TEST_ASSERT_FALSE(Buttons::Read(event));
+  Release(BUTTON_UP);
+  TEST_ASSERT_TRUE(Buttons::Read(event));
+  TEST_ASSERT_UINT32_WITHIN(HELD_SLACK_MS, BUTTON_DEBOUNCE_MS + 11,
+                            event.held);
+}
+
+// Wait() returns right away with events left, and sleeps no longer than the
+// window while a button is unsettled
+static void test_wait() {
+  typedef std::chrono::steady_clock Clock;
+  Press(BUTTON_UP);
+  Advance(100);
+  Release(BUTTON_UP);
+  Clock::time_point start = Clock::now();
+  Buttons::Wait(5000);
+  TEST_ASSERT_LESS_THAN(100, std::chrono::duration_cast<
+                                 std::chrono::milliseconds>(Clock::now() -
+                                                            start)
+                                 .count());
+  ButtonEvent event;
+  TEST_ASSERT_TRUE(Buttons::Read(event));
+
+  ulTaskNotifyTake(pdTRUE, 0);
+  Advance(100);
+  Press(BUTTON_UP);
+  Advance(10);
+  Release(BUTTON_UP);
+  start = Clock::now();
+  Buttons::Wait(5000);
+  const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          Clock::now() - start)
+                          .count();
+  TEST_ASSERT_GREATER_OR_EQUAL(BUTTON_DEBOUNCE_MS - HELD_SLACK_MS, waited);
+  TEST_ASSERT_LESS_THAN(BUTTON_DEBOUNCE_MS * 4, waited);
+}
+
+// Events past a full ring are dropped, the ring keeps the oldest
+static void test_full_ring_drops() {
+  for (int i = 0; i < BUTTON_EVENTS + 4; ++i) {
+    Press(BUTTON_UP);
+    Advance(100 + i);
+    Release(BUTTON_UP);
+    Advance(100);
+  }
+  ButtonEvent event;
+  int events = 0;
+  uint32_t first_held = 0;
+  while (Buttons::Read(event)) {
+    if (events++ == 0) {
+      first_held = event.held;
+    }
+  }
+  TEST_ASSERT_EQUAL(BUTTON_EVENTS - 1, events);
+  TEST_ASSERT_UINT32_WITHIN(HELD_SLACK_MS, 100, first_held);
+}
+
+int main(int argc, char **argv) {
+  Buttons::Setup();
+  UNITY_BEGIN();
+  RUN_TEST(test_press);
+  RUN_TEST(test_long_press);
+  RUN_TEST(test_bounce);
+  RUN_TEST(test_early_release_resampled);
+  RUN_TEST(test_bounce_back_settles);
+  RUN_TEST(test_wait);
+  RUN_TEST(test_full_ring_drops);
+  return UNITY_END();
+}
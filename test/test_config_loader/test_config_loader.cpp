@@ -0,0 +1,226 @@
+/*
+ *
+ * test_config_loader.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <ConfigLoader.h>
+#include <DeviceTable.h>
+#include <unity.h>
+
+#include <chrono>
+#include <string>
+
+#define BENCHMARK_DEVICES 5000
+
+// Only the required keys
+static const char kNetwork[] =
+    "network:\n"
+    "  ip: 192.168.100.12\n"
+    "  gateway: 192.168.100.1\n"
+    "  netmask: 255.255.255.0\n"
+    "  DNS: 192.168.100.1\n"
+    "  NTP1: 192.168.100.1\n"
+    "  hostname: wol.example\n"
+    "timezone: UTC0\n"
+    "ota_password_hash: 0123456789abcdef\n"
+    "wol:\n"
+    "  startup: 1\n"
+    "  repeat: 10\n"
+    "  port: 9\n"
+    "web:\n"
+    "  enabled: false\n";
+
+static const char kDevice[] =
+    "devices:\n"
+    "  - name: nas\n"
+    "    mac: 00:1a:2b:3c:4d:5e\n";
+
+static NetworkConfig config;
+static std::vector<WolDevice> devices;
+static char error[ConfigLoader::kErrorSize];
+
+void setUp() {}
+void tearDown() {}
+
+static bool Load(const std::string &yaml, ConfigLoadStats *stats = nullptr) {
+  fs::File file(yaml);
+  return ConfigLoader::Load(file, config, devices, error, stats);
+}
+
+// Replaces the line that starts with line_start, or drops it if line is empty
+static std::string Replace(const char *line_start, const char *line) {
+  std::string yaml = std::string(kDevice) + kNetwork;
+  const size_t start = yaml.find(line_start);
+  TEST_ASSERT_TRUE_MESSAGE(start != std::string::npos, line_start);
+  const size_t end = yaml.find('\n', start) + 1;
+  yaml.replace(start, end - start, *line ? std::string(line) + "\n" : "");
+  return yaml;
+}
+
+static void AssertRejected(const std::string &yaml, const char *message) {
+  TEST_ASSERT_FALSE(Load(yaml));
+  TEST_ASSERT_EQUAL_STRING(message, error);
+}
+
+static void test_defaults() {
+  TEST_ASSERT_TRUE_MESSAGE(Load(std::string(kDevice) + kNetwork), error);
+  TEST_ASSERT_EQUAL_STRING("", error);
+  TEST_ASSERT_EQUAL_UINT16(9, config.wol_port);
+  TEST_ASSERT_EQUAL_UINT16(kDefaultWolRate, config.wol_rate);
+  TEST_ASSERT_EQUAL_UINT16(kDefaultWolBurst, config.wol_burst);
+  TEST_ASSERT_FALSE(config.wol_raw);
+  TEST_ASSERT_EQUAL_UINT16(0, config.max_concurrent_boots);
+  TEST_ASSERT_EQUAL_UINT16(kDefaultBootTimeout, config.boot_timeout);
+  TEST_ASSERT_EQUAL_UINT16(kDefaultWolQuietWindow, config.wol_quiet_window);
+  TEST_ASSERT_EQUAL_UINT16(kDefaultProbeBackoff, config.probe_backoff);
+  TEST_ASSERT_EQUAL_UINT16(kDefaultProbeMaxBackoff, config.probe_max_backoff);
+  TEST_ASSERT_EQUAL_UINT16(kDefaultProbeTimeout, config.probe_timeout);
+  TEST_ASSERT_EQUAL_UINT16(kDefaultWebRate, config.web_rate);
+  TEST_ASSERT_EQUAL_UINT16(kDefaultWebBurst, config.web_burst);
+  TEST_ASSERT_TRUE(config.ntp2.isEmpty());
+  TEST_ASSERT_EQUAL_STRING("wol.example", config.hostname.c_str());
+  TEST_ASSERT_EQUAL_HEX32(htonl(0xC0A8640C), (uint32_t)config.ip);
+
+  TEST_ASSERT_EQUAL(1, devices.size());
+  TEST_ASSERT_EQUAL_STRING("nas", devices[0].name.c_str());
+  TEST_ASSERT_EQUAL_INT16(-1, devices[0].vlan);
+  TEST_ASSERT_EQUAL(kProbeNone, devices[0].probe.type);
+}
+
+static void test_range_rejections() {
+  AssertRejected(Replace("  port: 9", "  port: 0"),
+                 "wol:port\nmust be 1-65535 in\nYAML config.");
+  AssertRejected(Replace("  port: 9", "  port: 65536"),
+                 "wol:port\nmust be 1-65535 in\nYAML config.");
+  AssertRejected(Replace("  port: 9", "  port: 9x"),
+                 "wol:port\nmust be 1-65535 in\nYAML config.");
+  AssertRejected(Replace("  port: 9", "  port: 9\n  burst: 65"),
+                 "wol:burst\nmust be 1-64 in\nYAML config.");
+  AssertRejected(Replace("  port: 9", "  port: 9\n  rate: 1001"),
+                 "wol:rate\nmust be 1-1000 in\nYAML config.");
+  AssertRejected(Replace("web:", "probe:\n  timeout: 9\nweb:"),
+                 "probe:timeout\nmust be 10-10000 in\nYAML config.");
+  AssertRejected(Replace("web:", "probe:\n  backoff: 20\n  max_backoff: 10\n"
+                                 "web:"),
+                 "Invalid probe\nbackoff or timeout\nin YAML config.");
+  AssertRejected(Replace("  enabled: false", "  enabled: maybe"),
+                 "Invalid web:enabled\nin YAML config.");
+  AssertRejected(Replace("  ip: ", "  ip: 192.168.100"),
+                 "Invalid network:ip\nin YAML config.");
+  const std::string name(DeviceTable::kMaxNameLength + 1, 'n');
+  AssertRejected(Replace("  - name: nas", ("  - name: " + name).c_str()),
+                 "Device name over\n64 chars in YAML\nconfig.");
+  AssertRejected(Replace("    mac: ", ("    group: " + name + "\n    mac: "
+                                       "00:1a:2b:3c:4d:5e").c_str()),
+                 "Device group over\n64 chars in YAML\nconfig.");
+
+  // Range ends are allowed
+  TEST_ASSERT_TRUE_MESSAGE(
+      Load(Replace("  port: 9", "  port: 65535\n  burst: 64")), error);
+  TEST_ASSERT_EQUAL_UINT16(65535, config.wol_port);
+  TEST_ASSERT_EQUAL_UINT16(64, config.wol_burst);
+  TEST_ASSERT_TRUE_MESSAGE(
+      Load(Replace("  - name: nas",
+                   ("  - name: " + name.substr(1)).c_str())),
+      error);
+}
+
+static void test_missing_required_keys() {
+  AssertRejected(Replace("  hostname:", ""),
+                 "No network:hostname\nin YAML config.");
+  AssertRejected(Replace("ota_password_hash:", ""),
+                 "No ota_password_hash\nin YAML config.");
+  AssertRejected(Replace("  port: 9", ""), "No wol:port\nin YAML config.");
+  AssertRejected(Replace("  enabled: false", "  enabled: true"),
+                 "No web:user in\nYAML config.");
+  AssertRejected(Replace("    mac: ", ""),
+                 "Device without\nname or mac in\nYAML config.");
+  AssertRejected(kNetwork,
+                 "No target devices\nconfigured in\nYAML config.");
+}
+
+static void test_wol_target() {
+  uint32_t ip = 0;
+  TEST_ASSERT_TRUE(ConfigLoader::ParseWolTarget("10.0.0.7", ip));
+  TEST_ASSERT_EQUAL_HEX32(htonl(0x0A000007), ip);
+  TEST_ASSERT_TRUE(ConfigLoader::ParseWolTarget("10.0.0.0/24", ip));
+  TEST_ASSERT_EQUAL_HEX32(htonl(0x0A0000FF), ip);
+  TEST_ASSERT_TRUE(ConfigLoader::ParseWolTarget("10.0.0.0/32", ip));
+  TEST_ASSERT_EQUAL_HEX32(htonl(0x0A000000), ip);
+
+  const char *invalid[] = {"10.0.0.0/24abc", "10.0.0.0/", "10.0.0.0/33",
+                           "10.0.0.0/-1",    "10.0.0.0/ 24", "10.0.0.0/+24",
+                           "10.0.0/24",      "0.0.0.0"};
+  for (const char *target : invalid) {
+    TEST_ASSERT_FALSE_MESSAGE(ConfigLoader::ParseWolTarget(target, ip),
+                              target);
+  }
+
+  ProbeTarget probe = {0, 0, kProbeNone};
+  TEST_ASSERT_TRUE(ConfigLoader::ParseProbe("tcp:22", probe));
+  TEST_ASSERT_EQUAL(kProbeTcp, probe.type);
+  TEST_ASSERT_EQUAL_UINT16(22, probe.tcp_port);
+  TEST_ASSERT_FALSE(ConfigLoader::ParseProbe("tcp:22x", probe));
+  TEST_ASSERT_FALSE(ConfigLoader::ParseProbe("tcp:", probe));
+  TEST_ASSERT_FALSE(ConfigLoader::ParseProbe("tcp:65536", probe));
+  TEST_ASSERT_FALSE(ConfigLoader::ParseProbe("udp:7", probe));
+}
+
+static void test_benchmark_5000_devices() {
+  std::string yaml = "devices:\n";
+  char device[256];
+  for (unsigned i = 0; i < BENCHMARK_DEVICES; ++i) {
+    snprintf(device, sizeof(device),
+             "  - name: \"device %u\"\n"
+             "    mac: \"02:00:00:00:%02x:%02x\"\n"
+             "    group: rack-%u\n"
+             "    tags: [\"tag-%u\", all]\n"
+             "    host: 10.0.%u.%u\n"
+             "    probe: tcp:22\n",
+             i, i >> 8, i & 0xFF, i % 50, i % 20, i >> 8, i & 0xFF);
+    yaml += device;
+  }
+  yaml += kNetwork;
+
+  ConfigLoadStats stats;
+  const auto start = std::chrono::steady_clock::now();
+  TEST_ASSERT_TRUE_MESSAGE(Load(yaml, &stats), error);
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  TEST_ASSERT_EQUAL(BENCHMARK_DEVICES, devices.size());
+  const WolDevice &last = devices.back();
+  TEST_ASSERT_EQUAL_STRING("device 4999", last.name.c_str());
+  TEST_ASSERT_EQUAL_STRING("02:00:00:00:13:87", last.mac.c_str());
+  TEST_ASSERT_EQUAL_STRING("rack-49", last.group.c_str());
+  TEST_ASSERT_EQUAL(2, last.tags.size());
+  TEST_ASSERT_EQUAL_STRING("all", last.tags[1].c_str());
+  TEST_ASSERT_EQUAL(kProbeTcp, last.probe.type);
+  TEST_ASSERT_EQUAL_HEX32(htonl(0x0A001387), last.probe.ip);
+
+  char msg[128];
+  snprintf(msg, sizeof(msg),
+           "%u devices, %u bytes: %lld us, %.2f us/device, %u events",
+           BENCHMARK_DEVICES, (unsigned)yaml.size(), (long long)us,
+           (double)us / BENCHMARK_DEVICES, (unsigned)stats.events);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_defaults);
+  RUN_TEST(test_range_rejections);
+  RUN_TEST(test_missing_required_keys);
+  RUN_TEST(test_wol_target);
+  RUN_TEST(test_benchmark_5000_devices);
+  return UNITY_END();
+}
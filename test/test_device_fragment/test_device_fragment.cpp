@@ -0,0 +1,172 @@
+/*
+ *
+ * test_device_fragment.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <DeviceFragment.h>
+#include <PageTemplate.h>
+#include <unity.h>
+
+#include <chrono>
+#include <string>
+
+#define BENCHMARK_DEVICES 500
+#define BENCHMARK_PAGES 200
+#define CHUNK_SIZE 1436  // what an AsyncWebServer chunk usually gets
+
+static const char kRowEnd[] =
+    " />\n<span class='value'></span>\n</label>\n<br>\n";
+static const char *const kNames[] = {"DEVICES"};
+static const char kPage[] = "<html><form>\n%DEVICES%</form></html>\n";
+
+void setUp() {}
+void tearDown() {}
+
+static void Fill(DeviceTable &table, size_t count) {
+  char name[32];
+  for (size_t i = 0; i < count; ++i) {
+    snprintf(name, sizeof(name), "Device %u", (unsigned)i);
+    table.Add(0x020000000000ULL + i, name, "", {});
+  }
+  table.BuildIndexes();
+}
+
+static void test_row() {
+  DeviceTable table;
+  table.Add(0x001A2B3C4D5E, "NAS", "", {});
+  table.BuildIndexes();
+  DeviceFragment fragment;
+  fragment.Build(table);
+
+  char buf[PageRenderer::kItemSize];
+  const size_t length = fragment.Render(0, " up", true, buf, sizeof(buf));
+  const char expected[] =
+      "<label class='toggle'>\n<span class='text'>NAS (00:1a:2b:3c:4d:5e) "
+      "up</span>\n<input type='checkbox' id='00:1a:2b:3c:4d:5e' "
+      "name='00:1a:2b:3c:4d:5e' checked />\n<span class='value'></span>\n"
+      "</label>\n<br>\n";
+  TEST_ASSERT_EQUAL_STRING(expected, buf);
+  TEST_ASSERT_EQUAL(sizeof(expected) - 1, length);
+
+  fragment.Render(0, "", false, buf, sizeof(buf));
+  TEST_ASSERT_NULL(strstr(buf, "checked"));
+}
+
+// The longest name with the longest state fills the item buffer of the page
+// renderer, but isn't cut off.
+static void test_longest_row_fits() {
+  const std::string name(DeviceTable::kMaxNameLength, 'n');
+  const std::string state(PageRenderer::kItemSize -
+                              DeviceFragment::kMaxRowLength - 1,
+                          's');
+  DeviceTable table;
+  table.Add(0xFFFFFFFFFFFF, name.c_str(), "", {});
+  table.BuildIndexes();
+  DeviceFragment fragment;
+  fragment.Build(table);
+
+  char buf[PageRenderer::kItemSize];
+  const size_t length =
+      fragment.Render(0, state.c_str(), true, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(strlen(buf), length);
+  TEST_ASSERT_EQUAL_STRING(kRowEnd, buf + length - (sizeof(kRowEnd) - 1));
+  TEST_ASSERT_NOT_NULL(strstr(buf, name.c_str()));
+  TEST_ASSERT_NOT_NULL(strstr(buf, state.c_str()));
+}
+
+// The String concatenation the page used to be built with
+static std::string ConcatenatedRows(const DeviceTable &table) {
+  std::string devices = "";
+  for (size_t i = 0; i < table.size(); ++i) {
+    char mac[DeviceTable::kMacStringSize];
+    table.FormatMac(i, mac);
+    devices += "        <label class='toggle'>\n";
+    devices += "          <span class='text'>";
+    devices += table.Name(i);
+    devices += " (";
+    devices += mac;
+    devices += ")</span>\n";
+    devices += "          <input type='checkbox' id='";
+    devices += mac;
+    devices += "' name='";
+    devices += mac;
+    devices += "' checked />\n";
+    devices += "          <span class='value'></span>\n";
+    devices += "        </label>\n";
+    devices += "        <br>\n";
+  }
+  return devices;
+}
+
+static void test_benchmark_500_devices() {
+  DeviceTable table;
+  Fill(table, BENCHMARK_DEVICES);
+  DeviceFragment fragment;
+  fragment.Build(table);
+  PageTemplate page;
+  page.Parse(kPage, sizeof(kPage) - 1, kNames, 1);
+
+  uint8_t chunk[CHUNK_SIZE];
+  size_t page_size = 0;
+  size_t rows = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int p = 0; p < BENCHMARK_PAGES; ++p) {
+    PageRenderer renderer(page, [&](uint8_t placeholder, size_t item,
+                                    char *buf, size_t size) -> size_t {
+      if (item >= fragment.size()) {
+        return PageRenderer::kNoItem;
+      }
+      rows++;
+      return fragment.Render(item, "", true, buf, size);
+    });
+    page_size = 0;
+    size_t n;
+    while ((n = renderer.Read(chunk, sizeof(chunk))) > 0) {
+      page_size += n;
+    }
+  }
+  const auto rendered = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+  TEST_ASSERT_EQUAL(BENCHMARK_DEVICES * BENCHMARK_PAGES, rows);
+
+  size_t concatenated_size = 0;
+  start = std::chrono::steady_clock::now();
+  for (int p = 0; p < BENCHMARK_PAGES; ++p) {
+    concatenated_size += ConcatenatedRows(table).size();
+  }
+  const auto concatenated =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+  TEST_ASSERT_GREATER_THAN(0, concatenated_size);
+
+  char msg[128];
+  snprintf(msg, sizeof(msg),
+           "%u devices, %u byte page: %.1f us/page rendered, "
+           "%.1f us/page concatenated",
+           BENCHMARK_DEVICES, (unsigned)page_size,
+           rendered / 1000.0 / BENCHMARK_PAGES,
+           concatenated / 1000.0 / BENCHMARK_PAGES);
+  TEST_MESSAGE(msg);
+  snprintf(msg, sizeof(msg), "prebuilt rows: %u bytes",
+           (unsigned)fragment.MemoryUsage());
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_row);
+  RUN_TEST(test_longest_row_fits);
+  RUN_TEST(test_benchmark_500_devices);
+  return UNITY_END();
+}
@@ -0,0 +1,135 @@
+/*
+ *
+ * test_device_table.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <DeviceTable.h>
+#include <unity.h>
+
+#include <chrono>
+#include <cstdio>
+
+#define BENCHMARK_DEVICES 10000
+#define BENCHMARK_LOOKUPS 100000
+
+void setUp() {}
+void tearDown() {}
+
+static uint64_t MacOf(size_t i) { return 0x001A2B000000ULL + i * 7919; }
+
+// Fills the table the way a large config looks: unique names, 50 groups
+// and two tags per device out of 20.
+static void Fill(DeviceTable &table, size_t count) {
+  table.Clear();
+  char name[32];
+  char group[16];
+  char tag[16];
+  for (size_t i = 0; i < count; ++i) {
+    snprintf(name, sizeof(name), "device-%05u", (unsigned)i);
+    snprintf(group, sizeof(group), "rack-%02u", (unsigned)(i % 50));
+    snprintf(tag, sizeof(tag), "tag-%02u", (unsigned)(i % 20));
+    TEST_ASSERT_TRUE(table.Add(MacOf(i), name, group, {tag, "all"}));
+  }
+  table.BuildIndexes();
+}
+
+static void test_lookups() {
+  DeviceTable table;
+  table.Add(0x001A2B3C4D5E, "nas", "storage", {"always", "backup"});
+  table.Add(0x000000000001, "printer", "", {});
+  table.Add(0xFFFFFFFFFFFF, "tv", "media", {"always"});
+  table.BuildIndexes();
+
+  TEST_ASSERT_EQUAL_UINT16(0, table.Find(0x001A2B3C4D5E));
+  TEST_ASSERT_EQUAL_UINT16(1, table.Find(0x000000000001));
+  TEST_ASSERT_EQUAL_UINT16(2, table.Find(0xFFFFFFFFFFFF));
+  TEST_ASSERT_EQUAL_UINT16(DeviceTable::kNotFound, table.Find(0x2));
+  TEST_ASSERT_EQUAL_STRING("printer", table.Name(1));
+  TEST_ASSERT_EQUAL_STRING("", table.Group(1));
+
+  char mac[DeviceTable::kMacStringSize];
+  table.FormatMac(0, mac);
+  TEST_ASSERT_EQUAL_STRING("00:1a:2b:3c:4d:5e", mac);
+
+  DeviceRange always = table.FindTag("always");
+  TEST_ASSERT_EQUAL(2, always.size());
+  TEST_ASSERT_EQUAL_UINT16(0, always.first[0]);
+  TEST_ASSERT_EQUAL_UINT16(2, always.first[1]);
+  TEST_ASSERT_EQUAL(1, table.FindGroup("media").size());
+  TEST_ASSERT_EQUAL(0, table.FindGroup("").size());
+  TEST_ASSERT_EQUAL(0, table.FindTag("missing").size());
+}
+
+static void test_duplicate_mac() {
+  DeviceTable table;
+  table.Add(0x001A2B3C4D5E, "nas", "", {});
+  table.Add(0x000000000001, "printer", "", {});
+  table.BuildIndexes();
+  TEST_ASSERT_EQUAL_UINT16(DeviceTable::kNotFound, table.FindDuplicate());
+
+  table.Add(0x001A2B3C4D5E, "nas-again", "", {});
+  table.BuildIndexes();
+  TEST_ASSERT_EQUAL_UINT16(2, table.FindDuplicate());
+}
+
+static void test_benchmark_10k_devices() {
+  DeviceTable table;
+  Fill(table, BENCHMARK_DEVICES);
+  TEST_ASSERT_EQUAL_UINT16(DeviceTable::kNotFound, table.FindDuplicate());
+
+  const double bytes = (double)table.MemoryUsage() / BENCHMARK_DEVICES;
+  char msg[96];
+  snprintf(msg, sizeof(msg), "%u devices: %.1f bytes/device",
+           BENCHMARK_DEVICES, bytes);
+  TEST_MESSAGE(msg);
+
+  // Every lookup has to hit, which also keeps it from being optimized out.
+  size_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < BENCHMARK_LOOKUPS; ++i) {
+    found += table.Find(MacOf(i % BENCHMARK_DEVICES)) ==
+             i % BENCHMARK_DEVICES;
+  }
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+  TEST_ASSERT_EQUAL(BENCHMARK_LOOKUPS, found);
+  snprintf(msg, sizeof(msg), "MAC lookup: %.1f ns",
+           (double)ns / BENCHMARK_LOOKUPS);
+  TEST_MESSAGE(msg);
+
+  found = 0;
+  char group[16];
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < BENCHMARK_LOOKUPS; ++i) {
+    snprintf(group, sizeof(group), "rack-%02u", (unsigned)(i % 50));
+    found += table.FindGroup(group).size();
+  }
+  ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now() - start)
+           .count();
+  TEST_ASSERT_EQUAL(BENCHMARK_LOOKUPS * (BENCHMARK_DEVICES / 50), found);
+  snprintf(msg, sizeof(msg), "group lookup: %.1f ns, including snprintf",
+           (double)ns / BENCHMARK_LOOKUPS);
+  TEST_MESSAGE(msg);
+
+  TEST_ASSERT_EQUAL(BENCHMARK_DEVICES, table.FindTag("all").size());
+  TEST_ASSERT_EQUAL(BENCHMARK_DEVICES / 20, table.FindTag("tag-07").size());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_lookups);
+  RUN_TEST(test_duplicate_mac);
+  RUN_TEST(test_benchmark_10k_devices);
+  return UNITY_END();
+}
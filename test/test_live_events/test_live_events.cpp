@@ -0,0 +1,230 @@
+/*
+ *
+ * test_live_events.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Simulated subscribers of the /events channel. The event source of the host
+records what the channel sends, the clock is moved forward a second before
+every tick. Devices 0 to 2 exist, higher indices were removed by a reload.
+*/
+
+#include <DeviceTable.h>
+#include <LiveEvents.h>
+#include <unity.h>
+
+#include <string>
+#include <vector>
+
+static const uint16_t kDevices = 3;
+
+static AsyncWebServer server;
+static AsyncEventSource *source;
+static LiveStatus current;
+static bool accept_clients = true;
+
+static void Status(LiveStatus &status) { status = current; }
+
+static void Mac(uint16_t index, char *buf) {
+  if (index < kDevices) {
+    snprintf(buf, DeviceTable::kMacStringSize, "02:00:00:00:00:%02X", index);
+  } else {
+    buf[0] = '\0';
+  }
+}
+
+static void Tick() {
+  host_clock_offset_us += 1000000;
+  LiveEvents::Tick();
+}
+
+// Data of the messages of one event type, in the order sent
+static std::vector<std::string> Sent(const char *event) {
+  std::vector<std::string> data;
+  for (const AsyncEventSource::Message &message : source->sent()) {
+    if (message.event == event) {
+      data.push_back(message.data);
+    }
+  }
+  return data;
+}
+
+void setUp() {
+  current = LiveStatus();
+  strlcpy(current.next_wol, "07:30", sizeof(current.next_wol));
+  current.link = true;
+  current.config_version = 2;
+  accept_clients = true;
+}
+
+// Leaves no client and nothing queued behind
+void tearDown() {
+  while (source->count() > 0) {
+    source->Disconnect();
+  }
+  Tick();
+  source->sent().clear();
+}
+
+static void test_full_status_on_connect() {
+  TEST_ASSERT_TRUE(source->Connect());
+  Tick();
+  const std::vector<std::string> status = Sent("status");
+  TEST_ASSERT_EQUAL(1, status.size());
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"next_wol\":\"07:30\",\"link\":true,\"ntp\":false,"
+      "\"first_wol_sent\":false,\"pending_packets\":0,"
+      "\"last_completed_job\":0,\"config_version\":2,\"coalesced_wakes\":0,"
+      "\"limited_requests\":0,\"dropped_events\":0}",
+      status[0].c_str());
+
+  // A second client gets everything again, so do the others
+  TEST_ASSERT_TRUE(source->Connect());
+  Tick();
+  TEST_ASSERT_EQUAL(2, Sent("status").size());
+  TEST_ASSERT_EQUAL_STRING(status[0].c_str(), Sent("status")[1].c_str());
+}
+
+static void test_status_changes_only() {
+  source->Connect();
+  Tick();
+  source->sent().clear();
+
+  Tick();
+  TEST_ASSERT_EQUAL(0, source->sent().size());
+
+  current.pending_packets = 5;
+  current.ntp = true;
+  Tick();
+  const std::vector<std::string> status = Sent("status");
+  TEST_ASSERT_EQUAL(1, status.size());
+  TEST_ASSERT_EQUAL_STRING("{\"ntp\":true,\"pending_packets\":5}",
+                           status[0].c_str());
+}
+
+static void test_pushes_once_per_second() {
+  source->Connect();
+  Tick();
+  source->sent().clear();
+
+  current.pending_packets = 1;
+  LiveEvents::Tick();  // the clock didn't move
+  TEST_ASSERT_EQUAL(0, source->sent().size());
+  Tick();
+  TEST_ASSERT_EQUAL(1, Sent("status").size());
+}
+
+static void test_batches_runs_of_events() {
+  source->Connect();
+  LiveEvents::PacketSent(0);
+  LiveEvents::PacketSent(1);
+  LiveEvents::DeviceOnline(2, 42);
+  LiveEvents::PacketSent(0);
+  Tick();
+
+  std::vector<std::string> events;
+  for (const AsyncEventSource::Message &message : source->sent()) {
+    if (message.event != "status") {
+      events.push_back(message.event + " " + message.data);
+    }
+  }
+  TEST_ASSERT_EQUAL(3, events.size());
+  TEST_ASSERT_EQUAL_STRING(
+      "sent [\"02:00:00:00:00:00\",\"02:00:00:00:00:01\"]", events[0].c_str());
+  TEST_ASSERT_EQUAL_STRING(
+      "online [{\"mac\":\"02:00:00:00:00:02\",\"seconds\":42}]",
+      events[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("sent [\"02:00:00:00:00:00\"]", events[2].c_str());
+}
+
+static void test_removed_devices_send_nothing() {
+  source->Connect();
+  LiveEvents::PacketSent(7);
+  LiveEvents::DeviceOnline(8, 1);
+  Tick();
+  TEST_ASSERT_EQUAL(0, Sent("sent").size());
+  TEST_ASSERT_EQUAL(0, Sent("online").size());
+
+  LiveEvents::PacketSent(7);
+  LiveEvents::PacketSent(1);
+  Tick();
+  const std::vector<std::string> sent = Sent("sent");
+  TEST_ASSERT_EQUAL(1, sent.size());
+  TEST_ASSERT_EQUAL_STRING("[\"02:00:00:00:00:01\"]", sent[0].c_str());
+}
+
+static void test_no_clients_drops_events() {
+  LiveEvents::PacketSent(0);
+  Tick();
+  TEST_ASSERT_EQUAL(0, source->sent().size());
+
+  // Whoever connects later starts from the full status, not old events
+  source->Connect();
+  Tick();
+  TEST_ASSERT_EQUAL(1, Sent("status").size());
+  TEST_ASSERT_EQUAL(0, Sent("sent").size());
+}
+
+static void test_full_queue_counts_dropped() {
+  source->Connect();
+  Tick();
+  source->sent().clear();
+
+  for (int i = 0; i < LIVE_EVENTS_QUEUE_SIZE + 6; i++) {
+    LiveEvents::PacketSent(i % kDevices);
+  }
+  Tick();
+  const std::vector<std::string> status = Sent("status");
+  TEST_ASSERT_EQUAL(1, status.size());
+  TEST_ASSERT_EQUAL_STRING("{\"dropped_events\":6}", status[0].c_str());
+
+  // Split over as many batches as it takes to fit the buffer
+  size_t entries = 0;
+  for (const std::string &batch : Sent("sent")) {
+    TEST_ASSERT_LESS_THAN(LIVE_EVENTS_BUFFER_SIZE, batch.size());
+    TEST_ASSERT_EQUAL('[', batch.front());
+    TEST_ASSERT_EQUAL(']', batch.back());
+    for (size_t pos = 0; (pos = batch.find("02:00", pos)) != std::string::npos;
+         pos++) {
+      entries++;
+    }
+  }
+  TEST_ASSERT_GREATER_THAN(1, Sent("sent").size());
+  TEST_ASSERT_EQUAL(LIVE_EVENTS_QUEUE_SIZE, entries);
+}
+
+static void test_rejected_client() {
+  accept_clients = false;
+  TEST_ASSERT_FALSE(source->Connect());
+  TEST_ASSERT_EQUAL(0, source->count());
+}
+
+int main(int argc, char **argv) {
+  if (!LiveEvents::Setup(
+          server,
+          [](AsyncWebServerRequest *request) { return accept_clients; },
+          Status, Mac)) {
+    return 1;
+  }
+  source = static_cast<AsyncEventSource *>(server.handlers().back());
+
+  UNITY_BEGIN();
+  RUN_TEST(test_full_status_on_connect);
+  RUN_TEST(test_status_changes_only);
+  RUN_TEST(test_pushes_once_per_second);
+  RUN_TEST(test_batches_runs_of_events);
+  RUN_TEST(test_removed_devices_send_nothing);
+  RUN_TEST(test_no_clients_drops_events);
+  RUN_TEST(test_full_queue_counts_dropped);
+  RUN_TEST(test_rejected_client);
+  return UNITY_END();
+}
@@ -0,0 +1,172 @@
+/*
+ *
+ * test_mac_parser.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+#include <WakeOnLanGenerator.h>
+#include <unity.h>
+
+#include <chrono>
+#include <regex>
+#include <sstream>
+
+static const MacAddress kMac = {0x00, 0x1a, 0x2b, 0x3c, 0x4d, 0x5e};
+static const MacAddress kUnset = {0xde, 0xad, 0xbe, 0xef, 0x00, 0x01};
+
+void setUp() {}
+void tearDown() {}
+
+static void AssertParses(const char *text, const MacAddress &expected) {
+  MacAddress parsed = kUnset;
+  TEST_ASSERT_TRUE_MESSAGE(WakeOnLanGenerator::parseMacAddr(text, parsed),
+                           text);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), parsed.data(), 6);
+}
+
+static void AssertRejects(const char *text) {
+  MacAddress parsed = kUnset;
+  TEST_ASSERT_FALSE_MESSAGE(WakeOnLanGenerator::parseMacAddr(text, parsed),
+                            text);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(kUnset.data(), parsed.data(), 6);
+}
+
+static void test_colon_and_dash() {
+  AssertParses("00:1a:2b:3c:4d:5e", kMac);
+  AssertParses("00-1a-2b-3c-4d-5e", kMac);
+  AssertParses("00:1A:2B:3C:4D:5E", kMac);
+  AssertParses("ff:ff:ff:ff:ff:ff", {0xff, 0xff, 0xff, 0xff, 0xff, 0xff});
+}
+
+static void test_cisco_dotted() {
+  AssertParses("001a.2b3c.4d5e", kMac);
+  AssertParses("001A.2B3C.4D5E", kMac);
+}
+
+static void test_bare_hex() {
+  AssertParses("001a2b3c4d5e", kMac);
+  AssertParses("001A2B3C4D5E", kMac);
+}
+
+static void test_mixed_separators() {
+  AssertRejects("00:1a-2b:3c:4d:5e");
+  AssertRejects("00-1a-2b-3c-4d:5e");
+  AssertRejects("00.1a.2b.3c.4d.5e");
+  AssertRejects("001a:2b3c:4d5e");
+  AssertRejects("001a.2b3c-4d5e");
+  AssertRejects("00:1a:2b3c:4d:5e");
+  AssertRejects("001a2b.3c4d5e");
+}
+
+static void test_bad_hex() {
+  AssertRejects("00:1g:2b:3c:4d:5e");
+  AssertRejects("00:1a:2b:3c:4d:5 ");
+  AssertRejects("0x1a2b3c4d5e");
+  AssertRejects("001a.2b3c.4d5z");
+  AssertRejects("00:1a:2b:3c:4d:\xe5" "e");
+  AssertRejects(" 01a2b3c4d5e");
+}
+
+static void test_lengths() {
+  AssertRejects("");
+  AssertRejects("001a2b3c4d5");            // 11
+  AssertRejects("001a2b3c4d5e0");          // 13
+  AssertRejects("00:1a:2b:3c:4d:5e:");     // 18
+  AssertRejects("00:1a:2b:3c:4d:5e:6f");  // 20
+  AssertRejects("001a.2b3c.4d5");          // 13
+  AssertRejects("00:1a:2b:3c:4d:5");       // 16
+  MacAddress parsed = kUnset;
+  TEST_ASSERT_FALSE(WakeOnLanGenerator::parseMacAddr(
+      static_cast<const char *>(nullptr), parsed));
+}
+
+static void test_is_valid_and_pack() {
+  TEST_ASSERT_TRUE(WakeOnLanGenerator::isValidMac("00:1a:2b:3c:4d:5e"));
+  TEST_ASSERT_TRUE(WakeOnLanGenerator::isValidMac(std::string("001a2b3c4d5e")));
+  TEST_ASSERT_FALSE(WakeOnLanGenerator::isValidMac("00:1a:2b:3c:4d"));
+  TEST_ASSERT_EQUAL_HEX64(0x001a2b3c4d5eULL,
+                          WakeOnLanGenerator::packMacAddr(kMac));
+}
+
+// The parser this library had before, a regex check followed by a
+// stringstream per byte into a new array. Only knows the colon form.
+static const std::regex kMacRegex(
+    "[a-fA-F0-9]{2}:[a-fA-F0-9]{2}:[a-fA-F0-9]{2}:[a-fA-F0-9]{2}:"
+    "[a-fA-F0-9]{2}:[a-fA-F0-9]{2}");
+
+static const uint8_t *RegexParse(const char *mac) {
+  if (!std::regex_match(mac, kMacRegex)) {
+    return nullptr;
+  }
+  uint8_t *parsed = new uint8_t[6];
+  std::stringstream converter;
+  unsigned temp;
+  for (uint8_t i = 0; i < 6; i++) {
+    converter << mac[i * 3] << mac[i * 3 + 1];
+    converter >> std::hex >> temp;
+    parsed[i] = temp;
+    converter.str("");
+    converter.clear();
+  }
+  return parsed;
+}
+
+static void test_benchmark_against_regex() {
+  static const char *const kInputs[] = {
+      "00:1a:2b:3c:4d:5e", "a4:bb:6d:00:12:ff", "00:1a:2b:3c:4d:5g",
+      "de:ad:be:ef:00:01"};
+  const size_t kRounds = 20000;
+  uint32_t checksum = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kRounds; ++i) {
+    const uint8_t *parsed = RegexParse(kInputs[i % 4]);
+    if (parsed != nullptr) {
+      checksum += parsed[5];
+      delete[] parsed;
+    }
+  }
+  const double regex_ns =
+      std::chrono::duration<double, std::nano>(
+          std::chrono::steady_clock::now() - start).count() / kRounds;
+
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kRounds; ++i) {
+    MacAddress parsed;
+    if (WakeOnLanGenerator::parseMacAddr(kInputs[i % 4], parsed)) {
+      checksum -= parsed[5];
+    }
+  }
+  const double table_ns =
+      std::chrono::duration<double, std::nano>(
+          std::chrono::steady_clock::now() - start).count() / kRounds;
+
+  char message[96];
+  snprintf(message, sizeof(message),
+           "regex+stringstream %.0f ns, table %.1f ns per parse",
+           regex_ns, table_ns);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_EQUAL_UINT32(0, checksum);
+  TEST_ASSERT_TRUE(table_ns < regex_ns);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_colon_and_dash);
+  RUN_TEST(test_cisco_dotted);
+  RUN_TEST(test_bare_hex);
+  RUN_TEST(test_mixed_separators);
+  RUN_TEST(test_bad_hex);
+  RUN_TEST(test_lengths);
+  RUN_TEST(test_is_valid_and_pack);
+  RUN_TEST(test_benchmark_against_regex);
+  return UNITY_END();
+}
@@ -0,0 +1,146 @@
+/*
+ *
+ * test_page_template.cpp
+ *
+ * Created on: 2026-10-18
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Templates are rendered with every read size from one byte to more than the
+whole page, as a chunked response may ask for any. Each render has to give
+the same page, with placeholders and items split anywhere between reads.
+*/
+
+#include <PageTemplate.h>
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+static const char *const kNames[] = {"NAME", "ITEMS", "EMPTY"};
+static const uint8_t kName = 0;
+static const uint8_t kItems = 1;
+static const uint8_t kEmpty = 2;
+
+static size_t item_count;
+static std::vector<size_t> fill_calls;  // per placeholder
+
+void setUp() {
+  item_count = 3;
+  fill_calls.assign(3, 0);
+}
+void tearDown() {}
+
+// NAME is one item, ITEMS item_count numbered ones, EMPTY none
+static size_t Fill(uint8_t placeholder, size_t item, char *buf, size_t size) {
+  fill_calls[placeholder]++;
+  if (placeholder == kItems && item < item_count) {
+    return snprintf(buf, size, "<li>%zu</li>", item);
+  }
+  if (placeholder == kName && item == 0) {
+    return snprintf(buf, size, "World");
+  }
+  return PageRenderer::kNoItem;
+}
+
+static std::string Render(const PageTemplate &page, size_t read_size) {
+  PageRenderer renderer(page, Fill);
+  std::string out;
+  std::vector<uint8_t> buffer(read_size);
+  for (size_t reads = 0; reads < 100000; ++reads) {
+    const size_t n = renderer.Read(buffer.data(), read_size);
+    if (n == 0) {
+      break;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(read_size, n);
+    out.append(reinterpret_cast<char *>(buffer.data()), n);
+  }
+  return out;
+}
+
+// Renders text with every read size and checks each against expected
+static void Check(const char *text, const char *expected) {
+  PageTemplate page;
+  page.Parse(text, strlen(text), kNames, 3);
+  const size_t longest = strlen(expected) + 2;
+  for (size_t read_size = 1; read_size <= longest; ++read_size) {
+    TEST_ASSERT_EQUAL_STRING(expected, Render(page, read_size).c_str());
+  }
+}
+
+static void test_placeholders_split_across_reads() {
+  Check("Hello %NAME%!", "Hello World!");
+  Check("<ul>%ITEMS%</ul>", "<ul><li>0</li><li>1</li><li>2</li></ul>");
+  Check("%NAME%%ITEMS%", "World<li>0</li><li>1</li><li>2</li>");
+  Check("%ITEMS%", "<li>0</li><li>1</li><li>2</li>");
+  Check("", "");
+}
+
+static void test_literal_percent() {
+  Check("100%", "100%");
+  Check("50%% off", "50%% off");
+  Check("%%NAME%", "%World");
+  Check("%NAME%%", "World%");
+  Check("width: 10%; %NAME% 20%", "width: 10%; World 20%");
+  Check("%UNKNOWN% %NAME%", "%UNKNOWN% World");
+  Check("%name%", "%name%");
+  Check("%NAME", "%NAME");
+}
+
+// A placeholder ends at its first kNoItem, the fill isn't asked again
+static void test_no_item_ends_placeholder() {
+  PageTemplate page;
+  const char text[] = "[%EMPTY%][%ITEMS%]";
+  page.Parse(text, sizeof(text) - 1, kNames, 3);
+  item_count = 0;
+  TEST_ASSERT_EQUAL_STRING("[][]", Render(page, 4).c_str());
+  TEST_ASSERT_EQUAL(1, fill_calls[kEmpty]);
+  TEST_ASSERT_EQUAL(1, fill_calls[kItems]);
+
+  fill_calls.assign(3, 0);
+  item_count = 2;
+  TEST_ASSERT_EQUAL_STRING("[][<li>0</li><li>1</li>]", Render(page, 3).c_str());
+  TEST_ASSERT_EQUAL(3, fill_calls[kItems]);
+}
+
+// An item longer than the item buffer is cut off, not overrun
+static void test_long_item_cut() {
+  PageTemplate page;
+  const char text[] = "%NAME%";
+  page.Parse(text, sizeof(text) - 1, kNames, 1);
+  const std::string item(PageRenderer::kItemSize * 2, 'x');
+  PageRenderer renderer(page, [&item](uint8_t placeholder, size_t index,
+                                      char *buf, size_t size) -> size_t {
+    if (index > 0) {
+      return PageRenderer::kNoItem;
+    }
+    return snprintf(buf, size, "%s", item.c_str());
+  });
+  std::string out;
+  uint8_t buffer[100];
+  size_t n;
+  while ((n = renderer.Read(buffer, sizeof(buffer))) != 0) {
+    out.append(reinterpret_cast<char *>(buffer), n);
+  }
+  TEST_ASSERT_EQUAL(PageRenderer::kItemSize - 1, out.size());
+  TEST_ASSERT_EQUAL_STRING(item.substr(0, out.size()).c_str(), out.c_str());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_placeholders_split_across_reads);
+  RUN_TEST(test_literal_percent);
+  RUN_TEST(test_no_item_ends_placeholder);
+  RUN_TEST(test_long_item_cut);
+  return UNITY_END();
+}
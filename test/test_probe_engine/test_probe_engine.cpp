@@ -0,0 +1,166 @@
+/*
+ *
+ * test_probe_engine.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Runs the probe engine task against loopback: a listening TCP socket is a
+device that is up, a closed port one that is down, and ICMP echo goes to
+127.0.0.1 when the host allows raw sockets.
+*/
+
+#include <ProbeEngine.h>
+#include <lwip/sockets.h>
+#include <unity.h>
+
+#include <atomic>
+
+#define WAIT_MS 5000
+
+static std::atomic<int> rewakes[3];
+static std::atomic<int> onlines[3];
+static std::atomic<uint32_t> rewake_version(0);
+static uint32_t version = 1;
+
+void setUp() {}
+void tearDown() {}
+
+static void OnRewake(uint32_t target_version, size_t index) {
+  rewake_version = target_version;
+  rewakes[index]++;
+}
+
+static void OnOnline(size_t index, uint32_t seconds) { onlines[index]++; }
+
+// Listens on an ephemeral loopback port, or only reserves one when listen
+// is false so connecting to it is refused.
+static uint16_t OpenPort(bool listen_on, int *sock_out) {
+  int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  TEST_ASSERT_EQUAL(0, bind(sock, (struct sockaddr *)&addr, sizeof(addr)));
+  socklen_t len = sizeof(addr);
+  getsockname(sock, (struct sockaddr *)&addr, &len);
+  if (listen_on) {
+    TEST_ASSERT_EQUAL(0, listen(sock, 64));
+    *sock_out = sock;
+  } else {
+    close(sock);
+  }
+  return ntohs(addr.sin_port);
+}
+
+// Replaces the targets, which resets every device state
+static void Start(const std::vector<ProbeTarget> &targets) {
+  for (int i = 0; i < 3; ++i) {
+    rewakes[i] = 0;
+    onlines[i] = 0;
+  }
+  const std::vector<int32_t> previous(targets.size(), -1);
+  TEST_ASSERT_TRUE(
+      ProbeEngine::Reload(targets, ++version, previous, 0, 0, 200));
+}
+
+static bool WaitForState(size_t index, HostState state) {
+  for (int waited = 0; waited < WAIT_MS; waited += 10) {
+    if (ProbeEngine::State(index) == state) {
+      return true;
+    }
+    delay(10);
+  }
+  return false;
+}
+
+static void test_tcp_probe() {
+  int server;
+  const uint16_t open_port = OpenPort(true, &server);
+  const uint16_t closed_port = OpenPort(false, nullptr);
+  const uint32_t loopback = htonl(INADDR_LOOPBACK);
+  Start({{loopback, open_port, kProbeTcp}, {loopback, closed_port, kProbeTcp}});
+
+  ProbeEngine::OnWolSent(0);
+  ProbeEngine::OnWolSent(1);
+  TEST_ASSERT_EQUAL(kHostWaking, ProbeEngine::State(0));
+  TEST_ASSERT_TRUE(WaitForState(0, kHostOnline));
+  TEST_ASSERT_EQUAL_UINT32(1, ProbeEngine::Histogram(0).Total());
+  TEST_ASSERT_EQUAL(1, onlines[0].load());
+  TEST_ASSERT_EQUAL(0, rewakes[0].load());
+
+  for (int waited = 0; waited < WAIT_MS && rewakes[1] == 0; waited += 10) {
+    delay(10);
+  }
+  TEST_ASSERT_GREATER_THAN(0, rewakes[1].load());
+  TEST_ASSERT_EQUAL(version, rewake_version.load());
+  TEST_ASSERT_EQUAL(kHostWaking, ProbeEngine::State(1));
+  TEST_ASSERT_EQUAL_UINT32(0, ProbeEngine::Histogram(1).Total());
+  close(server);
+}
+
+static void test_forced_wake_of_online_host() {
+  int server;
+  const uint16_t port = OpenPort(true, &server);
+  Start({{htonl(INADDR_LOOPBACK), port, kProbeTcp}});
+  ProbeEngine::OnWolSent(0);
+  TEST_ASSERT_TRUE(WaitForState(0, kHostOnline));
+  TEST_ASSERT_EQUAL_UINT32(1, ProbeEngine::Histogram(0).Total());
+  TEST_ASSERT_EQUAL_UINT32(1, ProbeEngine::WolAnswers(0));
+
+  // Only checks the host is still up, it is no new wake
+  ProbeEngine::OnWolSent(0);
+  TEST_ASSERT_EQUAL(kHostVerifying, ProbeEngine::State(0));
+  TEST_ASSERT_TRUE(WaitForState(0, kHostOnline));
+  TEST_ASSERT_EQUAL_UINT32(1, ProbeEngine::Histogram(0).Total());
+  TEST_ASSERT_EQUAL(1, onlines[0].load());
+  // but still counts as an answer to the wake
+  TEST_ASSERT_EQUAL_UINT32(2, ProbeEngine::WolAnswers(0));
+
+  // and rewakes it when it went down meanwhile
+  close(server);
+  ProbeEngine::OnWolSent(0);
+  TEST_ASSERT_TRUE(WaitForState(0, kHostUnknown));
+  TEST_ASSERT_EQUAL(1, rewakes[0].load());
+  TEST_ASSERT_EQUAL_UINT32(1, ProbeEngine::Histogram(0).Total());
+}
+
+static void test_icmp_probe() {
+  int sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+  if (sock < 0) {
+    TEST_IGNORE_MESSAGE("no raw socket permission for ICMP");
+  }
+  close(sock);
+  Start({{htonl(INADDR_LOOPBACK), 0, kProbeIcmp}});
+  ProbeEngine::OnWolSent(0);
+  TEST_ASSERT_TRUE(WaitForState(0, kHostOnline));
+  TEST_ASSERT_EQUAL_UINT32(1, ProbeEngine::Histogram(0).Total());
+}
+
+static void test_arp_probe_without_route() {
+  Start({{htonl(INADDR_LOOPBACK), 0, kProbeArp}});
+  ProbeEngine::OnWolSent(0);
+  for (int waited = 0; waited < WAIT_MS && rewakes[0] == 0; waited += 10) {
+    delay(10);
+  }
+  TEST_ASSERT_GREATER_THAN(0, rewakes[0].load());
+  TEST_ASSERT_EQUAL(kHostWaking, ProbeEngine::State(0));
+}
+
+int main(int argc, char **argv) {
+  ProbeEngine::Setup({}, version, OnRewake, 0, 0, 200);
+  ProbeEngine::SetOnlineCallback(OnOnline);
+  UNITY_BEGIN();
+  RUN_TEST(test_tcp_probe);
+  RUN_TEST(test_forced_wake_of_online_host);
+  RUN_TEST(test_icmp_probe);
+  RUN_TEST(test_arp_probe_without_route);
+  return UNITY_END();
+}
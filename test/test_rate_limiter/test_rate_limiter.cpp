@@ -0,0 +1,111 @@
+/*
+ *
+ * test_rate_limiter.cpp
+ *
+ * Created on: 2026-10-18
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Token buckets of the web rate limit. The clock is moved forward by hand,
+the real time that passes during a test is far less than one token at the
+rates used.
+*/
+
+#include <RateLimiter.h>
+#include <unity.h>
+
+static const uint32_t kSource = 0x0A00000A;  // 10.0.0.10
+
+static RateLimiter limiter;
+
+void setUp() { limiter.Setup(2, 5); }
+void tearDown() { host_clock_offset_us = 0; }
+
+// Requests of source allowed in a row
+static uint32_t Burst(uint32_t source) {
+  uint32_t allowed = 0;
+  while (limiter.Allow(source) && allowed < 100000) {
+    allowed++;
+  }
+  return allowed;
+}
+
+static void test_burst_limit() {
+  TEST_ASSERT_EQUAL_UINT32(5, Burst(kSource));
+  TEST_ASSERT_FALSE(limiter.Allow(kSource));
+
+  // Other sources have buckets of their own
+  TEST_ASSERT_EQUAL_UINT32(5, Burst(kSource + 1));
+  TEST_ASSERT_FALSE(limiter.Allow(kSource));
+}
+
+static void test_refill() {
+  Burst(kSource);
+  host_clock_offset_us += 400000;  // 0.8 tokens
+  TEST_ASSERT_FALSE(limiter.Allow(kSource));
+  host_clock_offset_us += 100000;
+  TEST_ASSERT_TRUE(limiter.Allow(kSource));
+  TEST_ASSERT_FALSE(limiter.Allow(kSource));
+
+  // Rejected requests don't use up the partial token
+  host_clock_offset_us += 250000;
+  TEST_ASSERT_FALSE(limiter.Allow(kSource));
+  host_clock_offset_us += 250000;
+  TEST_ASSERT_TRUE(limiter.Allow(kSource));
+
+  host_clock_offset_us += 1500000;
+  TEST_ASSERT_EQUAL_UINT32(3, Burst(kSource));
+}
+
+// However long a source was idle, it gets back a full bucket and no more
+static void test_refill_after_long_idle() {
+  // A burst past 32 bit millionths
+  limiter.Setup(1, UINT16_MAX);
+  TEST_ASSERT_EQUAL_UINT32(UINT16_MAX, Burst(kSource));
+  host_clock_offset_us += 50LL * 24 * 3600 * 1000000;  // past 32 bit ms
+  TEST_ASSERT_EQUAL_UINT32(UINT16_MAX, Burst(kSource));
+
+  limiter.Setup(2, 5);
+  Burst(kSource);
+  host_clock_offset_us += 3600LL * 1000000;  // past 32 bit token math
+  TEST_ASSERT_EQUAL_UINT32(5, Burst(kSource));
+}
+
+// A new source takes over the bucket used longest ago, with a full bucket
+static void test_least_recent_source_evicted() {
+  for (uint32_t i = 0; i < RATE_LIMITER_SOURCES; ++i) {
+    host_clock_offset_us += 1000;
+    Burst(kSource + i);
+  }
+  host_clock_offset_us += 1000;
+  TEST_ASSERT_FALSE(limiter.Allow(kSource));  // now the most recent
+  TEST_ASSERT_EQUAL_UINT32(5, Burst(kSource + RATE_LIMITER_SOURCES));
+
+  // kSource + 1 was evicted and starts over, the others are still empty
+  TEST_ASSERT_FALSE(limiter.Allow(kSource));
+  TEST_ASSERT_EQUAL_UINT32(5, Burst(kSource + 1));
+  TEST_ASSERT_FALSE(limiter.Allow(kSource + 3));
+}
+
+static void test_setup_resets_buckets() {
+  Burst(kSource);
+  limiter.Setup(2, 1);
+  TEST_ASSERT_EQUAL_UINT32(1, Burst(kSource));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_burst_limit);
+  RUN_TEST(test_refill);
+  RUN_TEST(test_refill_after_long_idle);
+  RUN_TEST(test_least_recent_source_evicted);
+  RUN_TEST(test_setup_resets_buckets);
+  return UNITY_END();
+}
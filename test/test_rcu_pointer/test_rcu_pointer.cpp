@@ -0,0 +1,140 @@
+/*
+ *
+ * test_rcu_pointer.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Reader threads hold snapshots while a writer keeps publishing new ones.
+Every snapshot counts its holders and checks on deletion that none is left,
+readers check the snapshot is intact for as long as they hold it.
+*/
+
+#include <RcuPointer.h>
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define STRESS_READERS 4
+#define STRESS_PUBLISHES 1000
+
+static const uint32_t kAlive = 0xA11FE;
+static const uint32_t kDeleted = 0xDEAD;
+
+static std::atomic<int> freed_while_held;
+static std::atomic<int> deleted;
+
+struct Snapshot {
+  explicit Snapshot(uint32_t v) : magic(kAlive), version(v), holders(0) {}
+  ~Snapshot() {
+    if (holders != 0) {
+      freed_while_held++;
+    }
+    magic = kDeleted;
+    deleted++;
+  }
+
+  volatile uint32_t magic;
+  uint32_t version;
+  mutable std::atomic<int> holders;
+};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_single_thread() {
+  deleted = 0;
+  {
+    RcuPointer<Snapshot> pointer;
+    TEST_ASSERT_FALSE(pointer.Read());
+    pointer.Publish(new Snapshot(1));
+    {
+      RcuPointer<Snapshot>::ReadGuard guard = pointer.Read();
+      TEST_ASSERT_EQUAL_UINT32(1, guard->version);
+    }
+    pointer.Publish(new Snapshot(2));
+    TEST_ASSERT_EQUAL(1, deleted.load());
+    TEST_ASSERT_EQUAL_UINT32(2, pointer.Read()->version);
+  }
+  TEST_ASSERT_EQUAL(2, deleted.load());
+}
+
+static void test_readers_hold_while_writer_publishes() {
+  freed_while_held = 0;
+  deleted = 0;
+  RcuPointer<Snapshot> pointer;
+  pointer.Publish(new Snapshot(0));
+
+  std::atomic<bool> stop(false);
+  std::atomic<int> corrupt(0);
+  std::atomic<int> backwards(0);
+  std::atomic<long> reads(0);
+  std::atomic<int> started(0);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < STRESS_READERS; ++r) {
+    readers.emplace_back([&, r]() {
+      uint32_t last_version = 0;
+      started++;
+      while (!stop) {
+        RcuPointer<Snapshot>::ReadGuard guard = pointer.Read();
+        guard->holders++;
+        if (guard->magic != kAlive) {
+          corrupt++;
+        }
+        if (guard->version < last_version) {
+          backwards++;
+        }
+        last_version = guard->version;
+        // Hold the snapshot across some publishes now and then
+        if ((reads++ + r) % 64 == 0) {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        } else {
+          std::this_thread::yield();
+        }
+        if (guard->magic != kAlive) {
+          corrupt++;
+        }
+        guard->holders--;
+      }
+    });
+  }
+
+  // The publishes have to overlap the reads, not finish before the first
+  while (started < STRESS_READERS) {
+    std::this_thread::yield();
+  }
+  for (uint32_t version = 1; version <= STRESS_PUBLISHES; ++version) {
+    pointer.Publish(new Snapshot(version));
+  }
+  stop = true;
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+
+  char msg[64];
+  snprintf(msg, sizeof(msg), "%d publishes, %ld reads", STRESS_PUBLISHES,
+           reads.load());
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_EQUAL(0, freed_while_held.load());
+  TEST_ASSERT_EQUAL(0, corrupt.load());
+  TEST_ASSERT_EQUAL(0, backwards.load());
+  TEST_ASSERT_EQUAL(STRESS_PUBLISHES, deleted.load());
+  TEST_ASSERT_GREATER_THAN(STRESS_PUBLISHES, reads.load());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_thread);
+  RUN_TEST(test_readers_hold_while_writer_publishes);
+  return UNITY_END();
+}
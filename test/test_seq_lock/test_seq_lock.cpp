@@ -0,0 +1,152 @@
+/*
+ *
+ * test_seq_lock.cpp
+ *
+ * Created on: 2026-10-18
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Reader threads copy the status out while a writer keeps replacing it. The
+writer derives every field of a status from one number, so a reader that
+got parts of two writes finds fields that disagree. Status has the fields
+of SystemStatus, whose header needs the Ethernet and web server libraries.
+*/
+
+#include <SeqLock.h>
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define STRESS_READERS 4
+#define STRESS_WRITES 100000
+
+struct Status {
+  uint32_t uptime;
+  int32_t wol_countdown;
+  char ip[16];
+  char date[11];
+  char time[9];
+  char boot[20];
+  char boot_date[16];
+  char boot_time[16];
+  char next_wol[32];
+  char next_wol_date[16];
+  char next_wol_time[16];
+  bool link;
+  bool ntp;
+  bool first_wol_sent;
+  uint32_t pending_packets;
+  uint32_t last_completed_job;
+};
+
+static void Make(uint32_t n, Status &status) {
+  memset(&status, 0, sizeof(status));
+  status.uptime = n;
+  status.wol_countdown = -(int32_t)n;
+  snprintf(status.ip, sizeof(status.ip), "10.0.%u.%u", n >> 8 & 0xFF,
+           n & 0xFF);
+  snprintf(status.date, sizeof(status.date), "%010u", n);
+  snprintf(status.time, sizeof(status.time), "%08u", n % 100000000);
+  snprintf(status.boot, sizeof(status.boot), "boot %u", n);
+  snprintf(status.boot_date, sizeof(status.boot_date), "%u", n);
+  snprintf(status.boot_time, sizeof(status.boot_time), "%x", n);
+  snprintf(status.next_wol, sizeof(status.next_wol), "next %u", n);
+  snprintf(status.next_wol_date, sizeof(status.next_wol_date), "%o", n);
+  snprintf(status.next_wol_time, sizeof(status.next_wol_time), "%u", ~n);
+  status.link = n & 1;
+  status.ntp = n & 2;
+  status.first_wol_sent = n & 4;
+  status.pending_packets = n * 3;
+  status.last_completed_job = n ^ 0x5A5A5A5A;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_single_thread() {
+  SeqLock<Status> lock;
+  Status status;
+  Status expected;
+  lock.Read(status);
+  TEST_ASSERT_EQUAL_UINT32(0, status.uptime);
+  TEST_ASSERT_EQUAL_STRING("", status.next_wol);
+  Make(42, expected);
+  lock.Write(expected);
+  lock.Read(status);
+  TEST_ASSERT_EQUAL_MEMORY(&expected, &status, sizeof(status));
+}
+
+static void test_readers_never_see_torn_status() {
+  SeqLock<Status> lock;
+  Status first;
+  Make(0, first);
+  lock.Write(first);
+
+  std::atomic<bool> stop(false);
+  std::atomic<int> torn(0);
+  std::atomic<int> backwards(0);
+  std::atomic<long> reads(0);
+  std::atomic<int> started(0);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < STRESS_READERS; ++r) {
+    readers.emplace_back([&]() {
+      uint32_t last = 0;
+      Status status;
+      Status expected;
+      started++;
+      do {
+        lock.Read(status);
+        Make(status.uptime, expected);
+        if (memcmp(&status, &expected, sizeof(status)) != 0) {
+          torn++;
+        }
+        if (status.uptime < last) {
+          backwards++;
+        }
+        last = status.uptime;
+        reads++;
+      } while (!stop);
+    });
+  }
+
+  // The writes have to overlap the reads, not finish before the first
+  while (started < STRESS_READERS) {
+    std::this_thread::yield();
+  }
+  Status status;
+  for (uint32_t n = 1; n <= STRESS_WRITES; ++n) {
+    Make(n, status);
+    lock.Write(status);
+  }
+  stop = true;
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+
+  char msg[64];
+  snprintf(msg, sizeof(msg), "%d writes, %ld reads", STRESS_WRITES,
+           reads.load());
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_EQUAL(0, torn.load());
+  TEST_ASSERT_EQUAL(0, backwards.load());
+  TEST_ASSERT_GREATER_OR_EQUAL(STRESS_READERS, reads.load());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_thread);
+  RUN_TEST(test_readers_never_see_torn_status);
+  return UNITY_END();
+}
@@ -0,0 +1,213 @@
+/*
+ *
+ * test_time_format.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Dates and times are checked against strftime(), durations against the
+token join the display and web page used before TimeFormat, with its
+trailing space trimmed like its readers did.
+*/
+
+#include <TimeFormat.h>
+#include <unity.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define BENCHMARK_DURATIONS 100000
+
+void setUp() {}
+void tearDown() {}
+
+static std::string OldDuration(uint32_t seconds, const char *prefix,
+                               const char *suffix, DateTimeType type) {
+  std::vector<std::string> tokens;
+  if (prefix[0] != '\0') {
+    tokens.push_back(prefix);
+  }
+  const uint32_t days = seconds / (24 * 3600);
+  const uint32_t hours = seconds / 3600 % 24;
+  const uint32_t minutes = seconds / 60 % 60;
+  if (days) {
+    tokens.push_back(std::to_string(days) + "d");
+  }
+  if (hours) {
+    tokens.push_back(std::to_string(hours) + "h");
+  }
+  if (minutes) {
+    tokens.push_back(std::to_string(minutes) + "m");
+  }
+  tokens.push_back(std::to_string(seconds % 60) + "s");
+  if (suffix[0] != '\0') {
+    tokens.push_back(suffix);
+  }
+
+  std::string str;
+  switch (type) {
+    case date_only:
+      str += tokens[0];
+      if (tokens.size() > 1) {
+        str += " " + tokens[1];
+      }
+      break;
+    case time_only:
+      for (size_t i = 2; i < tokens.size(); ++i) {
+        str += tokens[i] + " ";
+      }
+      break;
+    case all:
+      for (const std::string &token : tokens) {
+        str += token + " ";
+      }
+  }
+  while (!str.empty() && str.back() == ' ') {
+    str.pop_back();
+  }
+  return str;
+}
+
+static void CheckDuration(uint32_t seconds) {
+  static const char *const kAffixes[][2] = {{"in", ""}, {"", "ago"}};
+  static const DateTimeType kTypes[] = {all, date_only, time_only};
+  char buf[TimeFormat::kDurationSize];
+  for (const auto &affix : kAffixes) {
+    for (DateTimeType type : kTypes) {
+      const std::string expected =
+          OldDuration(seconds, affix[0], affix[1], type);
+      const size_t length = TimeFormat::Duration(seconds, affix[0], affix[1],
+                                                 type, buf, sizeof(buf));
+      TEST_ASSERT_EQUAL_STRING(expected.c_str(), buf);
+      TEST_ASSERT_EQUAL(expected.size(), length);
+    }
+  }
+}
+
+static void test_duration() {
+  char buf[TimeFormat::kDurationSize];
+  TimeFormat::Duration(0, "", "ago", all, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("0s ago", buf);
+  TimeFormat::Duration(59, "in", "", all, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("in 59s", buf);
+  TimeFormat::Duration(24 * 3600, "", "ago", all, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("1d 0s ago", buf);
+  TimeFormat::Duration(UINT32_MAX, "", "ago", all, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("49710d 6h 28m 15s ago", buf);
+  TimeFormat::Duration(UINT32_MAX, "", "ago", date_only, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("49710d 6h", buf);
+  TimeFormat::Duration(UINT32_MAX, "", "ago", time_only, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("28m 15s ago", buf);
+
+  const uint32_t kEdges[] = {0,         1,         59,        60,
+                             61,        3599,      3600,      3661,
+                             86399,     86400,     86401,     90061,
+                             604800,    31536000,  INT16_MAX, INT16_MAX + 1,
+                             INT32_MAX, UINT32_MAX};
+  for (uint32_t seconds : kEdges) {
+    CheckDuration(seconds);
+  }
+  for (uint64_t seconds = 0; seconds <= UINT32_MAX; seconds += 7919 * 13) {
+    CheckDuration(seconds);
+  }
+}
+
+static void test_date_time() {
+  static const char *const kFormats[] = {"%F %H:%M:%S", "%F", "%H:%M:%S"};
+  static const DateTimeType kTypes[] = {all, date_only, time_only};
+  char expected[TimeFormat::kDateTimeSize];
+  char buf[TimeFormat::kDateTimeSize];
+  // From 1970 into 2106, the range of an unsigned 32 bit time
+  for (int64_t t = 0; t <= UINT32_MAX; t += 86400 * 3 + 3671) {
+    const time_t time = t;
+    tm ti;
+    gmtime_r(&time, &ti);
+    for (size_t i = 0; i < 3; ++i) {
+      const size_t expected_length =
+          strftime(expected, sizeof(expected), kFormats[i], &ti);
+      const size_t length =
+          TimeFormat::DateTime(ti, kTypes[i], buf, sizeof(buf));
+      TEST_ASSERT_EQUAL_STRING(expected, buf);
+      TEST_ASSERT_EQUAL(expected_length, length);
+    }
+  }
+}
+
+// Text that doesn't fit leaves the buffer empty instead of cut off
+static void test_overflow_empties_buffer() {
+  tm ti = {};
+  ti.tm_year = 2026 - 1900;
+  ti.tm_mon = 9;
+  ti.tm_mday = 17;
+  ti.tm_hour = 7;
+  char buf[TimeFormat::kDateTimeSize];
+  TEST_ASSERT_EQUAL(19, TimeFormat::DateTime(ti, all, buf, 20));
+  TEST_ASSERT_EQUAL_STRING("2026-10-17 07:00:00", buf);
+  TEST_ASSERT_EQUAL(0, TimeFormat::DateTime(ti, all, buf, 19));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+  TEST_ASSERT_EQUAL(10, TimeFormat::DateTime(ti, date_only, buf, 11));
+  TEST_ASSERT_EQUAL(0, TimeFormat::DateTime(ti, date_only, buf, 10));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+
+  // The longest duration fits kDurationSize
+  char duration[TimeFormat::kDurationSize];
+  TEST_ASSERT_EQUAL(21, TimeFormat::Duration(UINT32_MAX, "", "ago", all,
+                                             duration, 22));
+  TEST_ASSERT_EQUAL(0, TimeFormat::Duration(UINT32_MAX, "", "ago", all,
+                                            duration, 21));
+  TEST_ASSERT_EQUAL_STRING("", duration);
+  TEST_ASSERT_EQUAL(0, TimeFormat::Duration(5, "in", "", all, duration, 1));
+  TEST_ASSERT_EQUAL_STRING("", duration);
+
+  // Nothing at all is written to an empty buffer
+  duration[0] = 'x';
+  TEST_ASSERT_EQUAL(0, TimeFormat::Duration(5, "in", "", all, duration, 0));
+  TEST_ASSERT_EQUAL('x', duration[0]);
+}
+
+static void test_benchmark_duration() {
+  char buf[TimeFormat::kDurationSize];
+  size_t length = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < BENCHMARK_DURATIONS; ++i) {
+    length += TimeFormat::Duration(i * 7919, "", "ago", all, buf,
+                                   sizeof(buf));
+  }
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+  size_t old_length = 0;
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < BENCHMARK_DURATIONS; ++i) {
+    old_length += OldDuration(i * 7919, "", "ago", all).size();
+  }
+  const auto old_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  TEST_ASSERT_EQUAL(old_length, length);
+
+  char msg[96];
+  snprintf(msg, sizeof(msg), "duration: %.1f ns, token join: %.1f ns",
+           (double)ns / BENCHMARK_DURATIONS,
+           (double)old_ns / BENCHMARK_DURATIONS);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_duration);
+  RUN_TEST(test_date_time);
+  RUN_TEST(test_overflow_empties_buffer);
+  RUN_TEST(test_benchmark_duration);
+  return UNITY_END();
+}
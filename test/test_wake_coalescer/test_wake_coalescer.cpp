@@ -0,0 +1,146 @@
+/*
+ *
+ * test_wake_coalescer.cpp
+ *
+ * Created on: 2026-10-18
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Claims of the wake coalescer, single threaded and from threads that race
+for the same devices like the web server and the Arduino loop do. Times are
+passed in, so no clock is needed.
+*/
+
+#include <WakeCoalescer.h>
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define RACE_THREADS 4
+#define RACE_ROUNDS 20000
+
+static const uint32_t kWindow = 1000;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_claims_within_window_join() {
+  WakeCoalescer wakes(2);
+  uint32_t job = 99;
+  TEST_ASSERT_TRUE(wakes.Claim(0, 5000, kWindow, job));
+  TEST_ASSERT_EQUAL_UINT32(99, job);  // untouched by a claim
+
+  // Not queued yet, later requests get no job
+  TEST_ASSERT_FALSE(wakes.Claim(0, 5100, kWindow, job));
+  TEST_ASSERT_EQUAL_UINT32(0, job);
+  wakes.SetJob(0, 7);
+  TEST_ASSERT_FALSE(wakes.Claim(0, 5999, kWindow, job));
+  TEST_ASSERT_EQUAL_UINT32(7, job);
+
+  // Devices are independent, the window starts at the claim
+  TEST_ASSERT_TRUE(wakes.Claim(1, 5999, kWindow, job));
+  TEST_ASSERT_TRUE(wakes.Claim(0, 6000, kWindow, job));
+  TEST_ASSERT_FALSE(wakes.Claim(0, 6001, kWindow, job));
+  TEST_ASSERT_EQUAL_UINT32(0, job);
+}
+
+// A claim whose job found the queue full lets the next request try again
+static void test_unqueued_claim_released() {
+  WakeCoalescer wakes(1);
+  uint32_t job = 0;
+  TEST_ASSERT_TRUE(wakes.Claim(0, 5000, kWindow, job));
+  wakes.SetJob(0, 0);
+  TEST_ASSERT_TRUE(wakes.Claim(0, 5001, kWindow, job));
+}
+
+static void test_millis_edges() {
+  WakeCoalescer wakes(1);
+  uint32_t job = 0;
+  // millis() of 0 still claims, and is joined like any other time
+  TEST_ASSERT_TRUE(wakes.Claim(0, 0, kWindow, job));
+  TEST_ASSERT_FALSE(wakes.Claim(0, 0, kWindow, job));
+  TEST_ASSERT_FALSE(wakes.Claim(0, 999, kWindow, job));
+
+  // The window spans the wrap of millis() after 49.7 days
+  TEST_ASSERT_TRUE(wakes.Claim(0, UINT32_MAX - 10, kWindow, job));
+  TEST_ASSERT_FALSE(wakes.Claim(0, 500, kWindow, job));
+  TEST_ASSERT_TRUE(wakes.Claim(0, kWindow - 11, kWindow, job));
+
+  // Without a window every request wakes
+  TEST_ASSERT_TRUE(wakes.Claim(0, kWindow - 11, 0, job));
+}
+
+// Threads request the same devices at the same time, exactly one claims each
+// device per round. The others get the job the claimer sets, or 0 before.
+static void test_concurrent_claims() {
+  const size_t kDevices = 4;
+  WakeCoalescer wakes(kDevices);
+  std::atomic<int> claims[RACE_ROUNDS];
+  std::atomic<int> wrong_jobs(0);
+  std::atomic<uint32_t> round(0);
+  std::atomic<int> done(0);
+  for (std::atomic<int> &count : claims) {
+    count = 0;
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < RACE_THREADS; ++t) {
+    threads.emplace_back([&]() {
+      for (uint32_t r = 1; r <= RACE_ROUNDS; ++r) {
+        while (round < r) {
+          std::this_thread::yield();
+        }
+        // Rounds are a window apart, device r % kDevices was last claimed
+        // kDevices rounds before
+        const size_t device = r % kDevices;
+        const uint32_t now = r * kWindow;
+        uint32_t job = 0;
+        if (wakes.Claim(device, now, kWindow, job)) {
+          claims[r - 1]++;
+          wakes.SetJob(device, r);
+        } else if (job != 0 && job != r) {
+          wrong_jobs++;
+        }
+        done++;
+      }
+    });
+  }
+  for (uint32_t r = 1; r <= RACE_ROUNDS; ++r) {
+    done = 0;
+    round = r;
+    while (done < RACE_THREADS) {
+      std::this_thread::yield();
+    }
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  int missed = 0;
+  int doubled = 0;
+  for (std::atomic<int> &count : claims) {
+    missed += count == 0;
+    doubled += count > 1;
+  }
+  TEST_ASSERT_EQUAL(0, missed);
+  TEST_ASSERT_EQUAL(0, doubled);
+  TEST_ASSERT_EQUAL(0, wrong_jobs.load());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_claims_within_window_join);
+  RUN_TEST(test_unqueued_claim_released);
+  RUN_TEST(test_millis_edges);
+  RUN_TEST(test_concurrent_claims);
+  return UNITY_END();
+}
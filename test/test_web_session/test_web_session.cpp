@@ -0,0 +1,193 @@
+/*
+ *
+ * test_web_session.cpp
+ *
+ * Created on: 2026-10-17
+ *
+ *--------------------------------------------------------------
+ * Copyright (c) 2026 SXR.
+ * This project is licensed under the MIT License.
+ * The MIT license can be found in the project root and at
+ * https://opensource.org/licenses/MIT.
+ *--------------------------------------------------------------
+ */
+
+/*
+Session tokens, Basic credentials and the password hash, and the CPU time
+of checking a request. Before the sessions, browsers sent Digest
+credentials with the page and each of its two assets, which the web server
+checked with three MD5 digests each. DigestCheck() does the same digests
+without the header parsing and String copies around them, so it is the
+lower bound of the old cost.
+*/
+
+#include <WebSession.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/md.h>
+#include <unity.h>
+
+#include <ctime>
+#include <string>
+
+#define BENCHMARK_REQUESTS 20000
+
+static const char kUser[] = "admin";
+static const char kPassword[] = "correct horse";
+
+void setUp() {
+  WebSession::PasswordHash password;
+  WebSession::Hash(kPassword, password);
+  WebSession::Setup(kUser, password);
+}
+
+void tearDown() { host_clock_offset_us = 0; }
+
+static std::string Basic(const char *credentials) {
+  unsigned char encoded[128];
+  size_t length = 0;
+  mbedtls_base64_encode(encoded, sizeof(encoded), &length,
+                        reinterpret_cast<const unsigned char *>(credentials),
+                        strlen(credentials));
+  return "Basic " + std::string(reinterpret_cast<char *>(encoded), length);
+}
+
+static std::string Cookie() {
+  char token[WebSession::kTokenSize];
+  WebSession::IssueToken(token);
+  return std::string("theme=dark; " WEB_SESSION_COOKIE "=") + token;
+}
+
+static void test_password() {
+  TEST_ASSERT_TRUE(WebSession::CheckPassword(kUser, kPassword));
+  TEST_ASSERT_FALSE(WebSession::CheckPassword(kUser, "correct horse "));
+  TEST_ASSERT_FALSE(WebSession::CheckPassword("admin2", kPassword));
+  TEST_ASSERT_FALSE(WebSession::CheckPassword("", ""));
+
+  // The salt in use is kept, so a reload can tell whether anything changed
+  WebSession::PasswordHash same;
+  WebSession::PasswordHash other;
+  WebSession::Hash(kPassword, same);
+  WebSession::Hash("battery staple", other);
+  TEST_ASSERT_TRUE(WebSession::Matches(kUser, same));
+  TEST_ASSERT_FALSE(WebSession::Matches("root", same));
+  TEST_ASSERT_FALSE(WebSession::Matches(kUser, other));
+}
+
+static void test_basic() {
+  TEST_ASSERT_TRUE(
+      WebSession::CheckBasic(Basic("admin:correct horse").c_str()));
+  TEST_ASSERT_FALSE(WebSession::CheckBasic(Basic("admin:wrong").c_str()));
+  TEST_ASSERT_FALSE(WebSession::CheckBasic(Basic("admin").c_str()));
+  TEST_ASSERT_FALSE(WebSession::CheckBasic("Basic !!!"));
+  TEST_ASSERT_FALSE(WebSession::CheckBasic("Digest username=\"admin\""));
+}
+
+static void test_cookie() {
+  const std::string cookie = Cookie();
+  TEST_ASSERT_TRUE(WebSession::CheckCookie(cookie.c_str()));
+  const size_t at = cookie.find('=', cookie.find(WEB_SESSION_COOKIE)) + 1;
+  const std::string token = cookie.substr(at);
+  TEST_ASSERT_TRUE(WebSession::CheckCookie(
+      (WEB_SESSION_COOKIE "=" + token + "; theme=dark").c_str()));
+
+  // Any change of expiry, nonce or MAC breaks the signature
+  for (size_t i = 0; i < token.size(); ++i) {
+    std::string tampered = cookie;
+    tampered[at + i] = tampered[at + i] == '0' ? '1' : '0';
+    TEST_ASSERT_FALSE(WebSession::CheckCookie(tampered.c_str()));
+  }
+  TEST_ASSERT_FALSE(WebSession::CheckCookie(cookie.substr(0, at + 8).c_str()));
+  TEST_ASSERT_FALSE(
+      WebSession::CheckCookie(("x" WEB_SESSION_COOKIE "=" + token).c_str()));
+  TEST_ASSERT_FALSE(WebSession::CheckCookie("theme=dark"));
+}
+
+static void test_cookie_expires() {
+  const std::string cookie = Cookie();
+  host_clock_offset_us += (int64_t)(WEB_SESSION_LIFETIME - 1) * 1000000;
+  TEST_ASSERT_TRUE(WebSession::CheckCookie(cookie.c_str()));
+  host_clock_offset_us += 2000000;
+  TEST_ASSERT_FALSE(WebSession::CheckCookie(cookie.c_str()));
+}
+
+static void test_sessions_end_with_setup() {
+  const std::string cookie = Cookie();
+  WebSession::PasswordHash password;
+  WebSession::Hash(kPassword, password);
+  WebSession::Setup(kUser, password);  // as on boot, with a new key
+  TEST_ASSERT_FALSE(WebSession::CheckCookie(cookie.c_str()));
+}
+
+static std::string Md5(const std::string &input) {
+  static const char kHex[] = "0123456789abcdef";
+  uint8_t digest[16];
+  mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_MD5),
+             reinterpret_cast<const unsigned char *>(input.data()),
+             input.size(), digest);
+  std::string hex;
+  for (uint8_t b : digest) {
+    hex += kHex[b >> 4];
+    hex += kHex[b & 0xF];
+  }
+  return hex;
+}
+
+// The digests of a Digest authentication check, qop=auth
+static bool DigestCheck(const char *uri, const std::string &response) {
+  const std::string ha1 = Md5(std::string(kUser) + ":asyncesp:" + kPassword);
+  const std::string ha2 = Md5(std::string("GET:") + uri);
+  return Md5(ha1 + ":6c3b2e1d9f0a4b7c:00000001:0a4f113b:auth:" + ha2) ==
+         response;
+}
+
+// CPU time per call of check, in ns
+template <typename Check>
+static double CpuTime(Check check) {
+  size_t accepted = 0;
+  const std::clock_t start = std::clock();
+  for (size_t i = 0; i < BENCHMARK_REQUESTS; ++i) {
+    accepted += check();
+  }
+  const double ns = 1e9 * (std::clock() - start) / CLOCKS_PER_SEC;
+  TEST_ASSERT_EQUAL(BENCHMARK_REQUESTS, accepted);
+  return ns / BENCHMARK_REQUESTS;
+}
+
+static void test_benchmark_request_cpu() {
+  const std::string ha1 = Md5(std::string(kUser) + ":asyncesp:" + kPassword);
+  const std::string digest =
+      Md5(ha1 + ":6c3b2e1d9f0a4b7c:00000001:0a4f113b:auth:" + Md5("GET:/"));
+  const std::string cookie = Cookie();
+  const std::string basic = Basic("admin:correct horse");
+
+  const double before = CpuTime([&] { return DigestCheck("/", digest); });
+  const double after =
+      CpuTime([&] { return WebSession::CheckCookie(cookie.c_str()); });
+  const double scripts =
+      CpuTime([&] { return WebSession::CheckBasic(basic.c_str()); });
+
+  // A page load was the page, main.css and wol.png, the assets are public now
+  char msg[128];
+  snprintf(msg, sizeof(msg),
+           "before: %.0f ns/request, %.0f ns/page (Digest, 3 requests)",
+           before, 3 * before);
+  TEST_MESSAGE(msg);
+  snprintf(msg, sizeof(msg),
+           "after: %.0f ns/request, %.0f ns/page (session cookie)", after,
+           after);
+  TEST_MESSAGE(msg);
+  snprintf(msg, sizeof(msg), "Basic credentials of scripts: %.0f ns/request",
+           scripts);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_password);
+  RUN_TEST(test_basic);
+  RUN_TEST(test_cookie);
+  RUN_TEST(test_cookie_expires);
+  RUN_TEST(test_sessions_end_with_setup);
+  RUN_TEST(test_benchmark_request_cpu);
+  return UNITY_END();
+}